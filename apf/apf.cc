@@ -65,6 +65,11 @@ void destroyMeshElement(MeshElement* e)
   delete e;
 }
 
+void resetMeshElement(MeshElement* e, MeshEntity* entity)
+{
+  e->reset(entity);
+}
+
 Field* makeField(
     Mesh* m,
     const char* name,
@@ -259,6 +264,11 @@ void destroyElement(Element* e)
   delete e;
 }
 
+void resetElement(Element* e, MeshEntity* entity)
+{
+  e->reset(entity);
+}
+
 MeshElement* getMeshElement(Element* e)
 {
   return e->getParent();
@@ -352,9 +362,9 @@ int countIntPoints(MeshElement* e, int order)
 
 void getIntPoint(MeshElement* e, int order, int point, Vector3& param)
 {
-  IntegrationPoint const* p = 
-    getIntegration(e->getType())->getAccurate(order)->getPoint(point);
-  param = p->param;
+  Integration const* r = getIntegration(e->getType())->getAccurate(order);
+  param = r->getPoint(point)->param;
+  e->setIntPoint(r, point);
 }
 
 double getIntWeight(MeshElement* e, int order, int point)
@@ -386,9 +396,7 @@ void getJacobian(MeshElement* e, Vector3 const& local, Matrix3x3& j)
 
 void getJacobianInv(MeshElement* e, Vector3 const& local, Matrix3x3& jinv)
 {
-  Matrix3x3 j;
-  getJacobian(e, local, j);
-  jinv = getJacobianInverse(j, e->getDimension());
+  e->getJacobianInv(local, jinv);
 }
 
 double computeCosAngle(Mesh* m, MeshEntity* pe, MeshEntity* e1, MeshEntity* e2,
@@ -448,7 +456,7 @@ void getMatrixNodes(Element* e, NewArray<Matrix3x3>& values)
 void getShapeValues(Element* e, Vector3 const& local,
     NewArray<double>& values)
 {
-  e->getShape()->getValues(e->getMesh(), e->getEntity(), local,values);
+  e->getShapeValues(local,values);
 }
 
 void getShapeGrads(Element* e, Vector3 const& local,
@@ -461,7 +469,7 @@ void getVectorShapeValues(Element* e, Vector3 const& local,
     NewArray<Vector3>& values)
 {
   NewArray<Vector3> vvals(values.size());
-  e->getShape()->getVectorValues(e->getMesh(), e->getEntity(), local, vvals);
+  e->getVectorValues(local, vvals);
 
   apf::Matrix3x3 Jinv;
   apf::getJacobianInv( e->getParent(), local, Jinv );
@@ -483,7 +491,7 @@ void getCurlShapeValues(Element* e, Vector3 const& local,
     NewArray<Vector3>& values)
 {
   NewArray<Vector3> cvals(values.size());
-  e->getShape()->getLocalVectorCurls(e->getMesh(), e->getEntity(), local, cvals);
+  e->getLocalVectorCurls(local, cvals);
 
   // Perform Piola transformation
   if (e->getDimension() == 3)
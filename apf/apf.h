@@ -126,6 +126,15 @@ MeshEntity * getMeshEntity(MeshElement * me);
   */
 void destroyMeshElement(MeshElement* e);
 
+/** \brief Rebind a Mesh Element to another entity.
+  *
+  * \details This reuses the storage of the Mesh Element, so loops
+  * over many entities can create one Mesh Element up front
+  * instead of one per entity. Field Elements created from this
+  * Mesh Element must then be rebound with apf::resetElement.
+  */
+void resetMeshElement(MeshElement* e, MeshEntity* entity);
+
 /** \brief The type of value the field stores.
   *
   * \details The near future may bring more complex tensors.
@@ -293,6 +302,14 @@ Element* createElement(Field* f, MeshEntity* e);
  */
 void destroyElement(Element* e);
 
+/** \brief Rebind a Field Element to another entity.
+  *
+  * \details This reuses the storage of the Field Element.
+  * For a Field Element made from a Mesh Element, first reset
+  * the Mesh Element and then pass the same entity here.
+  */
+void resetElement(Element* e, MeshEntity* entity);
+
 /** \brief Get the Mesh Element of a Field Element.
   *
   * \details Each apf::Element operates over
@@ -376,6 +393,11 @@ void getComponents(Element* e, Vector3 const& param, double* components);
 int countIntPoints(MeshElement* e, int order);
 
 /** \brief Get an integration point in an element.
+  *
+  * \details Until the next call, Elements of this MeshElement
+  * evaluated exactly at this point read the shape functions
+  * from a table instead of computing them again, for the
+  * shapes that allow it (see apf::FieldShape::canTabulate).
   *
   * \param order The polynomial order of accuracy.
   * \param point The integration point number.
@@ -789,6 +811,24 @@ bool isFrozen(Field* f);
  */
 double* getArrayData(Field* f);
 
+/** \brief Return the values of a frozen field on one entity.
+  \details This points into the array of apf::getArrayData at the
+  apf::countNodesOn times apf::countComponents values of (e),
+  found with one table lookup on meshes that provide
+  apf::Mesh::getTypeIndex, such as MDS meshes.
+  \returns the values of (e), or 0 if the field is not frozen,
+  the mesh has no such index or (e) has no nodes. */
+double* getArrayData(Field* f, MeshEntity* e);
+
+/** \brief Put the arrays of frozen fields back in mesh order
+  \details The arrays of frozen fields are laid out in the iteration
+  order the mesh had when they were frozen. After the mesh is reordered
+  (e.g. apf::reorderMdsMesh), this renumbers the node numberings the
+  arrays are indexed by to follow the new order and permutes each
+  array in place, so apf::getArrayData pointers stay valid
+  and no field is unfrozen. */
+void reorderFrozenFields(Mesh* m);
+
 /** \brief Initialize all nodal values with all-zero components */
 void zeroField(Field* f);
 
@@ -1,6 +1,12 @@
 #include "apfArrayData.h"
 #include "apfNumbering.h"
 #include "apfTagData.h"
+#include "apfNumberingClass.h"
+#include "apfShape.h"
+#include <pcu_util.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 namespace apf {
 
@@ -31,6 +37,43 @@ class ArrayDataOf : public FieldDataOf<T>
       num_var = n;      
       arraySize = f->countComponents()*countNodes(num_var);
       dataArray = new T[arraySize];
+      findOffsets();
+    }
+    /* fills the tables of where each entity starts in the array,
+       indexed by type and apf::Mesh::getTypeIndex. They are left
+       empty if the mesh has no such index. */
+    void findOffsets()
+    {
+      Mesh* m = this->field->getMesh();
+      FieldShape* s = this->field->getShape();
+      int nc = this->field->countComponents();
+      for (int t = 0; t < Mesh::TYPES; ++t) {
+        offsets[t].clear();
+        sizes[t] = s->countNodesOn(t) * nc;
+      }
+      for (int d = 0; d <= m->getDimension(); ++d) {
+        if (!s->hasNodesIn(d))
+          continue;
+        MeshIterator* it = m->begin(d);
+        MeshEntity* e;
+        while ((e = m->iterate(it))) {
+          int t = m->getType(e);
+          if (!sizes[t])
+            continue;
+          int i = m->getTypeIndex(e);
+          if (i < 0) {
+            m->end(it);
+            for (int t = 0; t < Mesh::TYPES; ++t)
+              offsets[t].clear();
+            return;
+          }
+          std::vector<int>& o = offsets[t];
+          if (i >= static_cast<int>(o.size()))
+            o.resize(i + 1, -1);
+          o[i] = getNumber(num_var, e, 0, 0) * nc;
+        }
+        m->end(it);
+      }
     }
     virtual ~ArrayDataOf()
     {
@@ -49,9 +92,24 @@ class ArrayDataOf : public FieldDataOf<T>
          I don't think  we want to remove entities from frozen fields */
       fail("removeEntity called on frozen field data");
     }
+    virtual T* getEntityData(MeshEntity* e)
+    {
+      Mesh* m = this->field->getMesh();
+      std::vector<int> const& o = offsets[m->getType(e)];
+      if (o.empty())
+        return 0;
+      int i = m->getTypeIndex(e);
+      if (i < 0 || i >= static_cast<int>(o.size()) || o[i] < 0)
+        return 0;
+      return this->dataArray + o[i];
+    }
     virtual void get(MeshEntity* e, T* data)
     {
       /* this retrieves all the data associated with (e) */
+      if (T const* p = getEntityData(e)) {
+        std::copy(p, p + sizes[this->field->getMesh()->getType(e)], data);
+        return;
+      }
       int first_node_index = getNumber(this->num_var,e,0,0);
       int num_nodes = this->field->countNodesOn(e);
       int num_components = this->field->countComponents();
@@ -63,6 +121,10 @@ class ArrayDataOf : public FieldDataOf<T>
     virtual void set(MeshEntity* e, T const* data)
     {
       /* this stores all the data associated with (e) */
+      if (T* p = getEntityData(e)) {
+        std::copy(data, data + sizes[this->field->getMesh()->getType(e)], p);
+        return;
+      }
       int first_node_index = getNumber(this->num_var,e,0,0);
       int num_nodes = this->field->countNodesOn(e);
       int num_components = this->field->countComponents();
@@ -79,6 +141,33 @@ class ArrayDataOf : public FieldDataOf<T>
     T* getDataArray() {
       return this->dataArray;
     }
+    Numbering* getNumbering() {
+      return this->num_var;
+    }
+    /* moves the values of node i to node newOf[i],
+       following the cycles of the permutation */
+    void permute(std::vector<int> const& newOf) {
+      int nc = this->field->countComponents();
+      std::vector<bool> done(newOf.size(), false);
+      std::vector<T> carry(nc);
+      std::vector<T> tmp(nc);
+      for (size_t start = 0; start < newOf.size(); ++start) {
+        if (done[start])
+          continue;
+        T* p = this->dataArray + start * nc;
+        carry.assign(p, p + nc);
+        size_t i = start;
+        do {
+          size_t j = newOf[i];
+          p = this->dataArray + j * nc;
+          tmp.assign(p, p + nc);
+          std::copy(carry.begin(), carry.end(), p);
+          carry.swap(tmp);
+          done[j] = true;
+          i = j;
+        } while (i != start);
+      }
+    }
     virtual FieldData* clone() {
       //FieldData* newData = new TagDataOf<double>();
       FieldData* newData = new ArrayDataOf<T>();
@@ -93,6 +182,8 @@ class ArrayDataOf : public FieldDataOf<T>
     Numbering* num_var; 
     int arraySize;
     T* dataArray;
+    std::vector<int> offsets[Mesh::TYPES];
+    int sizes[Mesh::TYPES];
 };
 
 template <class T>
@@ -130,6 +221,58 @@ template void freezeFieldData<double>(FieldBase* field);
 template void unfreezeFieldData<int>(FieldBase* field);
 template void unfreezeFieldData<double>(FieldBase* field);
 
+/* renumbers the nodes of (n) in mesh order,
+   returning the new number of each old one */
+static void renumberNodes(Mesh* m, Numbering* n, std::vector<int>& newOf)
+{
+  FieldShape* s = getShape(n);
+  newOf.assign(countNodes(n), -1);
+  int i = 0;
+  for (int d = 0; d < 4; ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    MeshIterator* it = m->begin(d);
+    MeshEntity* e;
+    while ((e = m->iterate(it))) {
+      int nnodes = n->countNodesOn(e);
+      for (int node = 0; node < nnodes; ++node) {
+        newOf[getNumber(n, e, node, 0)] = i;
+        number(n, e, node, 0, i++);
+      }
+    }
+    m->end(it);
+  }
+  PCU_ALWAYS_ASSERT(i == static_cast<int>(newOf.size()));
+}
+
+void reorderFrozenFields(Mesh* m)
+{
+  typedef std::vector<ArrayDataOf<double>*> Arrays;
+  std::map<Numbering*, Arrays> byNumbering;
+  for (int i = 0; i < m->countFields(); ++i) {
+    Field* f = m->getField(i);
+    if (!isFrozen(f))
+      continue;
+    ArrayDataOf<double>* a =
+      static_cast<ArrayDataOf<double>*>(f->getData());
+    byNumbering[a->getNumbering()].push_back(a);
+  }
+  std::vector<int> newOf;
+  std::map<Numbering*, Arrays>::iterator it;
+  for (it = byNumbering.begin(); it != byNumbering.end(); ++it) {
+    renumberNodes(m, it->first, newOf);
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      it->second[i]->permute(newOf);
+      it->second[i]->findOffsets();
+    }
+  }
+}
+
+double* getArrayData(Field* f, MeshEntity* e)
+{
+  return f->getData()->getEntityData(e);
+}
+
 double* getArrayData(Field* f) {
   if (!isFrozen(f)) {
     return 0;
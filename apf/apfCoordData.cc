@@ -48,6 +48,7 @@ void CoordData::set(MeshEntity* e, double const* data)
      in an ugly way, but it seems to be the right
      place to have support for changing coordinates */
   Vector3 const* v = reinterpret_cast<Vector3 const*>(data);
+  uncacheGeometry(mesh);
   static_cast<Mesh2*>(mesh)->setPoint_(e,0,*v);
 }
 
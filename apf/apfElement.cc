@@ -11,6 +11,7 @@
 #include "apfShape.h"
 #include "apfMesh.h"
 #include "apfVectorElement.h"
+#include "apfIntegrate.h"
 
 namespace apf {
 
@@ -23,6 +24,11 @@ void Element::init(Field* f, MeshEntity* e, VectorElement* p)
   parent = p;
   nen = shape->countNodes();
   nc = f->countComponents();
+  rule = 0;
+  point = 0;
+  tableRule = 0;
+  for (int i = 0; i < ShapeTable::KINDS; ++i)
+    tables[i] = 0;
   getNodeData();
 }
 
@@ -40,6 +46,21 @@ Element::~Element()
 {
 }
 
+void Element::reset(MeshEntity* e)
+{
+  PCU_ALWAYS_ASSERT(!parent || parent->getEntity() == e);
+  int oldType = getType();
+  entity = e;
+  if (getType() != oldType) {
+    shape = field->getShape()->getEntityShape(getType());
+    nen = shape->countNodes();
+    tableRule = 0;
+  }
+  rule = 0;
+  point = 0;
+  getNodeData();
+}
+
 Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim)
 {
   switch (dim) {
@@ -79,39 +100,110 @@ void Element::getGlobalGradients(Vector3 const& local,
 {
   PCU_ALWAYS_ASSERT_VERBOSE(!field->getShape()->isVectorShape(),
       "Not implemented for vector shape functions!");
-  Matrix3x3 J;
-  parent->getJacobian(local,J);
-  Matrix3x3 jinv = getJacobianInverse(J, getDimension());
-  NewArray<Vector3> localGradients;
-  shape->getLocalGradients(mesh, entity, local,localGradients);
+  Matrix3x3 jinv;
+  parent->getJacobianInv(local,jinv);
+  getLocalGradients(local,vectors);
   globalGradients.allocate(nen);
   for (int i=0; i < nen; ++i)
-    globalGradients[i] = jinv * localGradients[i];
+    globalGradients[i] = jinv * vectors[i];
 }
 
 void Element::getComponents(Vector3 const& xi, double* c)
 {
   // handle cases with vector shape functions
   if (field->getShape()->isVectorShape()) {
-    NewArray<Vector3> shapeValues;
-    shapeValues.allocate(nen);
-    getVectorShapeValues(this, xi, shapeValues);
+    vectors.allocate(nen);
+    getVectorShapeValues(this, xi, vectors);
     for (int ci = 0; ci < 3; ci++)
       c[ci] = 0.;
     for (int ni = 0; ni < nen; ni++)
       for (int ci = 0; ci < 3; ci++)
-      	c[ci] += nodeData[ni] * shapeValues[ni][ci];
+      	c[ci] += nodeData[ni] * vectors[ni][ci];
   }
   // handle cases with scalar shape functions
   else {
-    NewArray<double> shapeValues;
-    shape->getValues(mesh, entity, xi, shapeValues);
+    getShapeValues(xi, values);
     for (int ci = 0; ci < nc; ++ci)
       c[ci] = 0;
     for (int ni = 0; ni < nen; ++ni)
       for (int ci = 0; ci < nc; ++ci)
-	c[ci] += nodeData[ni * nc + ci] * shapeValues[ni];
+	c[ci] += nodeData[ni * nc + ci] * values[ni];
+  }
+}
+
+void Element::setIntPoint(Integration const* r, int p)
+{
+  rule = r;
+  point = p;
+}
+
+ShapeTable const* Element::findTable(int kind, Vector3 const& xi, int& p)
+{
+  Element* at = parent ? static_cast<Element*>(parent) : this;
+  Integration const* r = at->rule;
+  if (!r)
+    return 0;
+  p = at->point;
+  /* the table is only good at the very point it was made for */
+  Vector3 const& x = r->getPoint(p)->param;
+  if (x[0] != xi[0] || x[1] != xi[1] || x[2] != xi[2])
+    return 0;
+  if (r != tableRule) {
+    tableRule = r;
+    for (int i = 0; i < ShapeTable::KINDS; ++i)
+      tables[i] = 0;
   }
+  if (!tables[kind])
+    tables[kind] = getShapeTable(getFieldShape(), getType(), r, kind);
+  return tables[kind];
+}
+
+template <class T>
+static void copyRow(T const* row, int n, NewArray<T>& to)
+{
+  to.allocate(n);
+  for (int i = 0; i < n; ++i)
+    to[i] = row[i];
+}
+
+void Element::getShapeValues(Vector3 const& xi, NewArray<double>& values)
+{
+  int p;
+  ShapeTable const* t = findTable(ShapeTable::VALUES, xi, p);
+  if (t)
+    copyRow(t->getValues(p), nen, values);
+  else
+    shape->getValues(mesh, entity, xi, values);
+}
+
+void Element::getLocalGradients(Vector3 const& xi, NewArray<Vector3>& grads)
+{
+  int p;
+  ShapeTable const* t = findTable(ShapeTable::GRADIENTS, xi, p);
+  if (t)
+    copyRow(t->getVectors(p), nen, grads);
+  else
+    shape->getLocalGradients(mesh, entity, xi, grads);
+}
+
+void Element::getVectorValues(Vector3 const& xi, NewArray<Vector3>& values)
+{
+  int p;
+  ShapeTable const* t = findTable(ShapeTable::VECTORS, xi, p);
+  if (t)
+    copyRow(t->getVectors(p), nen, values);
+  else
+    shape->getVectorValues(mesh, entity, xi, values);
+}
+
+void Element::getLocalVectorCurls(Vector3 const& xi, NewArray<Vector3>& curls)
+{
+  int p;
+  ShapeTable const* t = findTable(ShapeTable::CURLS, xi, p);
+  if (t)
+    copyRow(t->getVectors(p), nen, curls);
+  else
+    shape->getLocalVectorCurls(mesh, entity, xi, curls);
 }
 
 void Element::getNodeData()
@@ -11,12 +11,14 @@
 #include "apfMesh.h"
 #include "apfField.h"
 #include "apfShape.h"
+#include "apfShapeTable.h"
 
 namespace apf {
 
 class EntityShape;
 class FieldShape;
 class VectorElement;
+class Integration;
 
 class Element
 {
@@ -36,9 +38,22 @@ class Element
     FieldShape* getFieldShape() {return field->getShape();}
     void getComponents(Vector3 const& xi, double* c);
     void getElementNodeData(NewArray<double>& d);
+    /* these evaluate getShape() at xi, reading the shape table
+       instead when xi is the integration point last given to
+       setIntPoint on this element or its parent */
+    void getShapeValues(Vector3 const& xi, NewArray<double>& values);
+    void getLocalGradients(Vector3 const& xi, NewArray<Vector3>& grads);
+    void getVectorValues(Vector3 const& xi, NewArray<Vector3>& values);
+    void getLocalVectorCurls(Vector3 const& xi, NewArray<Vector3>& curls);
+    void setIntPoint(Integration const* r, int p);
+    /* rebinds this element to another entity, reusing its
+       buffers. An element with a parent must be given the
+       entity its parent was just reset to. */
+    void reset(MeshEntity* e);
   protected:
     void init(Field* f, MeshEntity* e, VectorElement* p);
     void getNodeData();
+    ShapeTable const* findTable(int kind, Vector3 const& xi, int& p);
     Field* field;
     Mesh* mesh;
     MeshEntity* entity;
@@ -47,6 +62,14 @@ class Element
     int nen;
     int nc;
     NewArray<double> nodeData;
+    /* scratch space for evaluation, kept to avoid
+       reallocating it at every point */
+    NewArray<double> values;
+    NewArray<Vector3> vectors;
+    Integration const* rule;
+    int point;
+    Integration const* tableRule;
+    ShapeTable const* tables[ShapeTable::KINDS];
 };
 
 Matrix3x3 getJacobianInverse(Matrix3x3 J, int dim);
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2014 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfElementBlock.h"
+#include "apfShapeTable.h"
+#include "apfIntegrate.h"
+#include "apfField.h"
+#include "apfFieldData.h"
+#include "apfShape.h"
+#include "apfMesh.h"
+#include <pcu_util.h>
+#include <cmath>
+
+namespace apf {
+
+ElementBlock::ElementBlock(Field* f, int t, int order, int cap):
+  field(f),
+  mesh(f->getMesh()),
+  type(t),
+  capacity(cap),
+  size(0)
+{
+  FieldShape* fs = f->getShape();
+  FieldShape* xs = mesh->getShape();
+  if (fs->isVectorShape() || !fs->canTabulate() || !xs->canTabulate())
+    fail("ElementBlock: needs scalar shapes that can be tabulated");
+  dim = Mesh::typeDimension[t];
+  if (dim < 1)
+    fail("ElementBlock: needs elements of dimension 1 or more");
+  rule = getIntegration(t)->getAccurate(order);
+  if (!rule)
+    fail("ElementBlock: no integration rule of that order");
+  nc = f->countComponents();
+  nx = xs->getEntityShape(t)->countNodes();
+  nen = fs->getEntityShape(t)->countNodes();
+  points = rule->countPoints();
+  xGrads = getShapeTable(xs, t, rule, ShapeTable::GRADIENTS);
+  uValues = getShapeTable(fs, t, rule, ShapeTable::VALUES);
+  uGrads = getShapeTable(fs, t, rule, ShapeTable::GRADIENTS);
+  /* whole cache lines per array row */
+  stride = (capacity + 7) / 8 * 8;
+  entities.resize(capacity);
+  coords.resize(nx * 3 * stride);
+  nodes.resize(nen * nc * stride);
+  jacobians.resize(points * dim * 3 * stride);
+  inverses.resize(points * 3 * dim * stride);
+  dvs.resize(points * stride);
+  values.resize(points * nc * stride);
+  grads.resize(points * nc * 3 * stride);
+  local.resize(dim * stride);
+}
+
+static void scatter(NewArray<double> const& from, int n,
+    std::vector<double>& to, int stride, int lane)
+{
+  for (int i = 0; i < n; ++i)
+    to[i * stride + lane] = from[i];
+}
+
+void ElementBlock::gather(MeshEntity* const* elements, int n)
+{
+  PCU_ALWAYS_ASSERT(n <= capacity);
+  FieldDataOf<double>* xd = mesh->getCoordinateField()->getData();
+  FieldDataOf<double>* ud = field->getData();
+  for (int i = 0; i < n; ++i) {
+    MeshEntity* e = elements[i];
+    PCU_ALWAYS_ASSERT(mesh->getType(e) == type);
+    entities[i] = e;
+    xd->getElementData(e, scratch);
+    scatter(scratch, nx * 3, coords, stride, i);
+    ud->getElementData(e, scratch);
+    scatter(scratch, nen * nc, nodes, stride, i);
+  }
+  size = n;
+  if (!n)
+    return;
+  /* the kernels run over whole rows, so the unused lanes
+     repeat the last element to keep the arithmetic finite */
+  for (int i = n; i < stride; ++i) {
+    for (int j = 0; j < nx * 3; ++j)
+      coords[j * stride + i] = coords[j * stride + n - 1];
+    for (int j = 0; j < nen * nc; ++j)
+      nodes[j * stride + i] = nodes[j * stride + n - 1];
+  }
+}
+
+/* rows of NX or NEN nodes, with 0 meaning the count is
+   only known at run time */
+template <int D, int NX, int NEN>
+void evaluateBlock(ElementBlock* b)
+{
+  int const nx = NX ? NX : b->nx;
+  int const nen = NEN ? NEN : b->nen;
+  int const nc = b->nc;
+  int const s = b->stride;
+  for (int p = 0; p < b->points; ++p) {
+    Vector3 const* gx = b->xGrads->getVectors(p);
+    double* J = &b->jacobians[p * D * 3 * s];
+    for (int a = 0; a < D; ++a)
+      for (int j = 0; j < 3; ++j) {
+        double* Jaj = J + (a * 3 + j) * s;
+        for (int e = 0; e < s; ++e)
+          Jaj[e] = 0;
+        for (int n = 0; n < nx; ++n) {
+          double w = gx[n][a];
+          double const* x = &b->coords[(n * 3 + j) * s];
+          for (int e = 0; e < s; ++e)
+            Jaj[e] += w * x[e];
+        }
+      }
+    double* inv = &b->inverses[p * 3 * D * s];
+    double* dv = &b->dvs[p * s];
+    if (D == 3) {
+      /* inv[j][a] is the cofactor of J[a][j] over det(J) */
+      for (int e = 0; e < s; ++e)
+        dv[e] = J[0 * s + e] * (J[4 * s + e] * J[8 * s + e] -
+                                J[5 * s + e] * J[7 * s + e])
+              + J[1 * s + e] * (J[5 * s + e] * J[6 * s + e] -
+                                J[3 * s + e] * J[8 * s + e])
+              + J[2 * s + e] * (J[3 * s + e] * J[7 * s + e] -
+                                J[4 * s + e] * J[6 * s + e]);
+      for (int j = 0; j < 3; ++j)
+        for (int a = 0; a < 3; ++a) {
+          double const* m11 = J + (((a + 1) % 3) * 3 + (j + 1) % 3) * s;
+          double const* m22 = J + (((a + 2) % 3) * 3 + (j + 2) % 3) * s;
+          double const* m12 = J + (((a + 1) % 3) * 3 + (j + 2) % 3) * s;
+          double const* m21 = J + (((a + 2) % 3) * 3 + (j + 1) % 3) * s;
+          double* out = inv + (j * D + a) * s;
+          for (int e = 0; e < s; ++e)
+            out[e] = (m11[e] * m22[e] - m12[e] * m21[e]) / dv[e];
+        }
+    } else if (D == 2) {
+      /* the Moore-Penrose inverse J^T (J J^T)^{-1},
+         as in apf::getJacobianInverse */
+      double const* J0 = J;
+      double const* J1 = J + 3 * s;
+      for (int e = 0; e < s; ++e) {
+        double g00 = 0, g01 = 0, g11 = 0;
+        for (int j = 0; j < 3; ++j) {
+          g00 += J0[j * s + e] * J0[j * s + e];
+          g01 += J0[j * s + e] * J1[j * s + e];
+          g11 += J1[j * s + e] * J1[j * s + e];
+        }
+        double det = g00 * g11 - g01 * g01;
+        dv[e] = std::sqrt(det);
+        for (int j = 0; j < 3; ++j) {
+          inv[(j * 2 + 0) * s + e] =
+            (J0[j * s + e] * g11 - J1[j * s + e] * g01) / det;
+          inv[(j * 2 + 1) * s + e] =
+            (J1[j * s + e] * g00 - J0[j * s + e] * g01) / det;
+        }
+      }
+    } else {
+      for (int e = 0; e < s; ++e) {
+        double g00 = 0;
+        for (int j = 0; j < 3; ++j)
+          g00 += J[j * s + e] * J[j * s + e];
+        dv[e] = std::sqrt(g00);
+        for (int j = 0; j < 3; ++j)
+          inv[j * s + e] = J[j * s + e] / g00;
+      }
+    }
+    double const* N = b->uValues->getValues(p);
+    Vector3 const* gu = b->uGrads->getVectors(p);
+    for (int c = 0; c < nc; ++c) {
+      double* u = &b->values[(p * nc + c) * s];
+      for (int e = 0; e < s; ++e)
+        u[e] = 0;
+      for (int n = 0; n < nen; ++n) {
+        double w = N[n];
+        double const* un = &b->nodes[(n * nc + c) * s];
+        for (int e = 0; e < s; ++e)
+          u[e] += w * un[e];
+      }
+      double* l = &b->local[0];
+      for (int a = 0; a < D; ++a) {
+        double* la = l + a * s;
+        for (int e = 0; e < s; ++e)
+          la[e] = 0;
+        for (int n = 0; n < nen; ++n) {
+          double w = gu[n][a];
+          double const* un = &b->nodes[(n * nc + c) * s];
+          for (int e = 0; e < s; ++e)
+            la[e] += w * un[e];
+        }
+      }
+      for (int j = 0; j < 3; ++j) {
+        double* g = &b->grads[((p * nc + c) * 3 + j) * s];
+        for (int e = 0; e < s; ++e)
+          g[e] = 0;
+        for (int a = 0; a < D; ++a) {
+          double const* ija = inv + (j * D + a) * s;
+          double const* la = l + a * s;
+          for (int e = 0; e < s; ++e)
+            g[e] += ija[e] * la[e];
+        }
+      }
+    }
+  }
+}
+
+typedef void (*BlockKernel)(ElementBlock* b);
+
+struct BlockKernelEntry
+{
+  int dim;
+  int nx;
+  int nen;
+  BlockKernel kernel;
+};
+
+/* linear and quadratic simplices over linear or quadratic meshes */
+static BlockKernelEntry const blockKernels[] = {
+  {1, 2, 2, evaluateBlock<1,2,2>},
+  {1, 2, 3, evaluateBlock<1,2,3>},
+  {2, 3, 3, evaluateBlock<2,3,3>},
+  {2, 3, 6, evaluateBlock<2,3,6>},
+  {2, 6, 6, evaluateBlock<2,6,6>},
+  {3, 4, 4, evaluateBlock<3,4,4>},
+  {3, 4, 10, evaluateBlock<3,4,10>},
+  {3, 10, 10, evaluateBlock<3,10,10>}
+};
+
+void ElementBlock::evaluate()
+{
+  if (!size)
+    return;
+  int n = sizeof(blockKernels) / sizeof(blockKernels[0]);
+  for (int i = 0; i < n; ++i) {
+    BlockKernelEntry const& k = blockKernels[i];
+    if (k.dim == dim && k.nx == nx && k.nen == nen)
+      return k.kernel(this);
+  }
+  switch (dim) {
+    case 1:
+      return evaluateBlock<1,0,0>(this);
+    case 2:
+      return evaluateBlock<2,0,0>(this);
+    default:
+      return evaluateBlock<3,0,0>(this);
+  }
+}
+
+Vector3 const& ElementBlock::getPoint(int p) const
+{
+  return rule->getPoint(p)->param;
+}
+
+double ElementBlock::getWeight(int p) const
+{
+  return rule->getPoint(p)->weight;
+}
+
+}//namespace apf
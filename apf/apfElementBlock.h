@@ -0,0 +1,112 @@
+/*
+ * Copyright 2014 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFELEMENTBLOCK_H
+#define APFELEMENTBLOCK_H
+
+/** \file apfElementBlock.h
+  \brief Evaluation of a field over a block of elements at once */
+
+#include "apf.h"
+#include "apfNew.h"
+#include <vector>
+
+namespace apf {
+
+class Integration;
+class ShapeTable;
+
+/** \brief Evaluates a field on many elements of one type at once
+  \details the block gathers the nodal coordinates and field values
+  of up to capacity elements, then computes the Jacobians, their
+  determinants and inverses, and the field values and gradients at
+  every integration point of all of them.
+
+  Every array is laid out with the element index fastest, so that
+  each getter returns a pointer to countElements() contiguous
+  doubles, and the loops over elements are simple enough for the
+  compiler to vectorize. Common simplex element types and orders
+  have kernels with the node counts fixed at compile time.
+
+  The field and the mesh coordinates must use scalar shape functions
+  that can be tabulated, see apf::FieldShape::canTabulate. */
+class ElementBlock
+{
+  public:
+    /** \brief Prepare blocks of elements of this type
+      \param type select from apf::Mesh::Type
+      \param order the order of accuracy of the integration rule */
+    ElementBlock(Field* f, int type, int order, int capacity = 64);
+    /** \brief Gather the node data of n elements, up to capacity */
+    void gather(MeshEntity* const* elements, int n);
+    /** \brief Compute everything at all integration points */
+    void evaluate();
+    int countElements() const {return size;}
+    int countPoints() const {return points;}
+    int countComponents() const {return nc;}
+    int getDimension() const {return dim;}
+    /** \brief Returns the parent coordinates of integration point p */
+    Vector3 const& getPoint(int p) const;
+    /** \brief Returns the weight of integration point p */
+    double getWeight(int p) const;
+    /** \brief Returns the elements of the current block */
+    MeshEntity* const* getElements() const {return &entities[0];}
+    /** \brief Component c of the field at point p */
+    double const* getValues(int p, int c) const
+    {return at(values, (p * nc + c));}
+    /** \brief Derivative along axis j of component c at point p */
+    double const* getGrads(int p, int c, int j) const
+    {return at(grads, (p * nc + c) * 3 + j);}
+    /** \brief Entry J[a][j] of the Jacobian at point p,
+      the derivative of coordinate j along parent axis a */
+    double const* getJacobians(int p, int a, int j) const
+    {return at(jacobians, (p * dim + a) * 3 + j);}
+    /** \brief Entry [j][a] of the (pseudo-)inverse Jacobian at point p */
+    double const* getJacobianInverses(int p, int j, int a) const
+    {return at(inverses, (p * 3 + j) * dim + a);}
+    /** \brief The differential volume at point p,
+      as given by apf::getJacobianDeterminant */
+    double const* getDVs(int p) const {return at(dvs, p);}
+  private:
+    double const* at(std::vector<double> const& v, int i) const
+    {return &v[i * stride];}
+    template <int D, int NX, int NEN>
+    friend void evaluateBlock(ElementBlock* b);
+    Field* field;
+    Mesh* mesh;
+    Integration const* rule;
+    ShapeTable const* xGrads;
+    ShapeTable const* uValues;
+    ShapeTable const* uGrads;
+    int type;
+    int dim;
+    int nc;
+    int nx;
+    int nen;
+    int points;
+    int capacity;
+    int stride;
+    int size;
+    std::vector<MeshEntity*> entities;
+    /* node data, [node][component][element] */
+    std::vector<double> coords;
+    std::vector<double> nodes;
+    /* results, [point][...][element] */
+    std::vector<double> jacobians;
+    std::vector<double> inverses;
+    std::vector<double> dvs;
+    std::vector<double> values;
+    std::vector<double> grads;
+    /* local gradients of one component at one point */
+    std::vector<double> local;
+    /* scratch for gathering one element */
+    NewArray<double> scratch;
+};
+
+}//namespace apf
+
+#endif
@@ -1,7 +1,10 @@
 #include "apfFieldData.h"
 #include "apfShape.h"
 #include <pcu_util.h>
+#include <pcu_batch.h>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 namespace apf {
@@ -15,6 +18,19 @@ void FieldData::rename(const char*)
   abort();
 }
 
+/* one record per copy holds the remote entity and its values,
+   batched so that a phase costs a few large messages */
+enum { SYNC_CHUNK = 1 << 16 };
+
+template <class T>
+static void packValues(pcu::Batch& b, int to, MeshEntity* e,
+    const T* values, int n)
+{
+  char* at = static_cast<char*>(b.Reserve(to, sizeof(e) + n * sizeof(T)));
+  memcpy(at, &e, sizeof(e));
+  memcpy(at + sizeof(e), values, n * sizeof(T));
+}
+
 template <class T>
 void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
 {
@@ -32,7 +48,8 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       continue;
     MeshEntity* e;
     MeshIterator* it = m->begin(d);
-    m->getPCU()->Begin();
+    pcu::Batch batch(*m->getPCU(), SYNC_CHUNK, true);
+    batch.Begin();
     while ((e = m->iterate(it)))
     {
       if (( ! data->hasEntity(e))||
@@ -44,27 +61,21 @@ void synchronizeFieldData(FieldDataOf<T>* data, Sharing* shr, bool delete_shr)
       CopyArray copies;
       shr->getCopies(e, copies);
       for (size_t i = 0; i < copies.getSize(); ++i)
-      {
-        m->getPCU()->Pack(copies[i].peer, copies[i].entity);
-        m->getPCU()->Pack(copies[i].peer, &(values[0]), n*sizeof(T));
-      }
+        packValues(batch, copies[i].peer, copies[i].entity, &(values[0]), n);
       apf::Copies ghosts;  
       if (m->getGhosts(e, ghosts))
       APF_ITERATE(Copies, ghosts, it)
-      {
-        m->getPCU()->Pack(it->first, it->second);
-        m->getPCU()->Pack(it->first, &(values[0]), n*sizeof(T));
-      }
+        packValues(batch, it->first, it->second, &(values[0]), n);
     }
     m->end(it);
-    m->getPCU()->Send();
-    while (m->getPCU()->Receive())
+    batch.Send();
+    while (batch.Receive())
     {
       MeshEntity* e;
-      m->getPCU()->Unpack(e);
+      batch.Unpack(e);
       int n = f->countValuesOn(e);
       NewArray<T> values(n);
-      m->getPCU()->Unpack(&(values[0]),n*sizeof(T));
+      batch.Unpack(&(values[0]),n*sizeof(T));
       data->set(e,&(values[0]));
     }
   }
@@ -93,7 +104,8 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
 
     MeshEntity* e;
     MeshIterator* it = m->begin(d);
-    m->getPCU()->Begin();
+    pcu::Batch batch(*m->getPCU(), SYNC_CHUNK, true);
+    batch.Begin();
     while ((e = m->iterate(it)))
     {
       /* send to all parts that can see this entity */
@@ -120,10 +132,7 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
       data->get(e,&(values[0]));
 
       for (size_t i = 0; i < copies.getSize(); ++i)
-      {
-        m->getPCU()->Pack(copies[i].peer, copies[i].entity);
-        m->getPCU()->Pack(copies[i].peer, &(values[0]), n*sizeof(double));
-      }
+        packValues(batch, copies[i].peer, copies[i].entity, &(values[0]), n);
 
       // ghosts - only do them if this entity is on a partition boundary
       if (copies.getSize() > 0)
@@ -131,30 +140,26 @@ void reduceFieldData(FieldDataOf<double>* data, Sharing* shr, bool delete_shr, c
         apf::Copies ghosts;
         if (m->getGhosts(e, ghosts))
         APF_ITERATE(Copies, ghosts, it2)
-        {
-          m->getPCU()->Pack(it2->first, it2->second);
-          m->getPCU()->Pack(it2->first, &(values[0]), n*sizeof(double));
-        }
+          packValues(batch, it2->first, it2->second, &(values[0]), n);
       }
     }
     m->end(it);
 
-    m->getPCU()->Send();
-    while (m->getPCU()->Listen())
-      while ( ! m->getPCU()->Unpacked())
-      { /* receive and add. we only care about correctness
-           on the owners */
-        MeshEntity* e;
-        m->getPCU()->Unpack(e);
-        int n = f->countValuesOn(e);
-        NewArray<double> values(n);
-        NewArray<double> inValues(n);
-        m->getPCU()->Unpack(&(inValues[0]),n*sizeof(double));
-        data->get(e,&(values[0]));
-        for (int i = 0; i < n; ++i)
-          values[i] = reduce_op.apply(values[i], inValues[i]);
-        data->set(e,&(values[0]));
-      }
+    batch.Send();
+    while (batch.Receive())
+    { /* receive and add. we only care about correctness
+         on the owners */
+      MeshEntity* e;
+      batch.Unpack(e);
+      int n = f->countValuesOn(e);
+      NewArray<double> values(n);
+      NewArray<double> inValues(n);
+      batch.Unpack(&(inValues[0]),n*sizeof(double));
+      data->get(e,&(values[0]));
+      for (int i = 0; i < n; ++i)
+        values[i] = reduce_op.apply(values[i], inValues[i]);
+      data->set(e,&(values[0]));
+    }
   }
 
   // every partition did the reduction,s o no need to broadcast the result
@@ -165,6 +170,11 @@ template <class T>
 void FieldDataOf<T>::setNodeComponents(MeshEntity* e, int node,
     T const* components)
 {
+  int nc = field->countComponents();
+  if (T* data = getEntityData(e)) {
+    std::copy(components, components + nc, data + node * nc);
+    return;
+  }
   int n = field->countNodesOn(e);
   if (n==1) {
     PCU_ALWAYS_ASSERT(node == 0);
@@ -172,7 +182,6 @@ void FieldDataOf<T>::setNodeComponents(MeshEntity* e, int node,
   }
   PCU_ALWAYS_ASSERT(node >= 0);
   PCU_ALWAYS_ASSERT(node < n);
-  int nc = field->countComponents();
   NewArray<T> allComponents(nc*n);
   if (this->hasEntity(e))
     get(e,&(allComponents[0]));
@@ -184,6 +193,11 @@ void FieldDataOf<T>::setNodeComponents(MeshEntity* e, int node,
 template <class T>
 void FieldDataOf<T>::getNodeComponents(MeshEntity* e, int node, T* components)
 {
+  int nc = field->countComponents();
+  if (T const* data = getEntityData(e)) {
+    std::copy(data + node * nc, data + (node + 1) * nc, components);
+    return;
+  }
   int n = field->countNodesOn(e);
   if (n==1) {
     PCU_ALWAYS_ASSERT(node == 0);
@@ -191,7 +205,6 @@ void FieldDataOf<T>::getNodeComponents(MeshEntity* e, int node, T* components)
   }
   PCU_ALWAYS_ASSERT(node >= 0);
   PCU_ALWAYS_ASSERT(node < n);
-  int nc = field->countComponents();
   NewArray<T> allComponents(nc*n);
   get(e,&(allComponents[0]));
   for (int i=0; i < nc; ++i)
@@ -52,6 +52,9 @@ class FieldDataOf : public FieldData
   public:
     virtual void get(MeshEntity* e, T* data) = 0;
     virtual void set(MeshEntity* e, T const* data) = 0;
+    /* the values of (e) where they are stored,
+       or 0 if this storage can't point to them */
+    virtual T* getEntityData(MeshEntity*) {return 0;}
     void setNodeComponents(MeshEntity* e, int node, T const* components);
     void getNodeComponents(MeshEntity* e, int node, T* components);
     int getElementData(MeshEntity* entity, NewArray<T>& data);
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2014 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfGeometryCache.h"
+#include "apfMesh.h"
+#include "apfShape.h"
+#include "apfVectorElement.h"
+#include "apf.h"
+
+namespace apf {
+
+static bool isCached(Mesh* m, MeshEntity* e)
+{
+  int type = m->getType(e);
+  return type == Mesh::EDGE || type == Mesh::TRIANGLE || type == Mesh::TET;
+}
+
+/* the outward normal of a side, as seen from the element centroid */
+static Vector3 getSideNormal(Mesh* m, MeshEntity* side,
+    Matrix3x3 const& J, int dim, Vector3 const& center)
+{
+  Downward v;
+  m->getDownward(side, 0, v);
+  Vector3 x[3];
+  for (int i = 0; i < dim; ++i)
+    m->getPoint(v[i], 0, x[i]);
+  Vector3 n;
+  if (dim == 3)
+    n = cross(x[1] - x[0], x[2] - x[0]);
+  else if (dim == 2)
+    n = cross(x[1] - x[0], cross(J[0], J[1]));
+  else
+    n = J[0];
+  n = n.normalize();
+  if (n * (getLinearCentroid(m, side) - center) < 0)
+    n = n * -1;
+  return n;
+}
+
+GeometryCache::GeometryCache(Mesh* m, bool withNormals):
+  mesh(m)
+{
+  dim = m->getDimension();
+  tag = m->createIntTag("apf_geometry_cache", 1);
+  MeshIterator* it = m->begin(dim);
+  MeshEntity* e;
+  while ((e = m->iterate(it)))
+    if (isCached(m, e))
+      entities.push_back(e);
+  m->end(it);
+  size = entities.size();
+  jacobians.resize(9 * size);
+  inverses.resize(9 * size);
+  dvs.resize(size);
+  if (withNormals)
+    normals.resize((dim + 1) * 3 * size);
+  Vector3 center(1.0 / (dim + 1), 1.0 / (dim + 1), 1.0 / (dim + 1));
+  for (int i = 2; i >= dim; --i)
+    center[i] = 0;
+  for (int i = 0; i < size; ++i) {
+    e = entities[i];
+    m->setIntTag(e, tag, &i);
+    MeshElement* me = createMeshElement(m, e);
+    Matrix3x3 J;
+    me->getJacobian(center, J);
+    Matrix3x3 Jinv = apf::getJacobianInverse(J, dim);
+    for (int a = 0; a < 3; ++a)
+      for (int b = 0; b < 3; ++b) {
+        jacobians[(a * 3 + b) * size + i] = J[a][b];
+        inverses[(a * 3 + b) * size + i] = Jinv[a][b];
+      }
+    dvs[i] = getJacobianDeterminant(J, dim);
+    destroyMeshElement(me);
+    if (!withNormals)
+      continue;
+    Vector3 c = getLinearCentroid(m, e);
+    Downward sides;
+    int n = m->getDownward(e, dim - 1, sides);
+    for (int s = 0; s < n; ++s) {
+      Vector3 v = getSideNormal(m, sides[s], J, dim, c);
+      for (int j = 0; j < 3; ++j)
+        normals[(s * 3 + j) * size + i] = v[j];
+    }
+  }
+}
+
+int GeometryCache::find(MeshEntity* e)
+{
+  if (!mesh->hasTag(e, tag))
+    return -1;
+  int slot;
+  mesh->getIntTag(e, tag, &slot);
+  return has(slot, e) ? slot : -1;
+}
+
+void GeometryCache::destroyTag()
+{
+  for (int i = 0; i < size; ++i)
+    mesh->removeTag(entities[i], tag);
+  mesh->destroyTag(tag);
+}
+
+void cacheGeometry(Mesh* m, bool normals)
+{
+  uncacheGeometry(m);
+  FieldShape* s = m->getShape();
+  if (s != getLagrange(1))
+    return;
+  m->geometryCache = new GeometryCache(m, normals);
+}
+
+void uncacheGeometry(Mesh* m)
+{
+  if (!m->geometryCache)
+    return;
+  /* detach first, the tag removal must not see the cache */
+  GeometryCache* c = m->geometryCache;
+  m->geometryCache = 0;
+  c->destroyTag();
+  delete c;
+}
+
+bool hasCachedGeometry(Mesh* m)
+{
+  return m->geometryCache;
+}
+
+bool getCachedNormal(Mesh* m, MeshEntity* e, int i, Vector3& n)
+{
+  GeometryCache* c = m->geometryCache;
+  if (!c || !c->hasNormals())
+    return false;
+  int slot = c->find(e);
+  if (slot < 0)
+    return false;
+  c->getNormal(slot, i, n);
+  return true;
+}
+
+}//namespace apf
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFGEOMETRYCACHE_H
+#define APFGEOMETRYCACHE_H
+
+#include "apfMatrix.h"
+#include <vector>
+
+namespace apf {
+
+class Mesh;
+class MeshEntity;
+class MeshTag;
+
+/* the constant geometric factors of the straight-sided simplices
+   of a mesh, one array per quantity and component, indexed by
+   a slot stored in a tag on each element. The arrays are filled
+   once and never change; the whole cache is dropped instead. */
+class GeometryCache
+{
+  public:
+    GeometryCache(Mesh* m, bool withNormals);
+    /* leaves the tag alone, see apf::uncacheGeometry */
+    ~GeometryCache() {}
+    /* returns the slot of e, or -1 if it has none */
+    int find(MeshEntity* e);
+    bool has(int slot, MeshEntity* e) const
+    {
+      return slot >= 0 && slot < size && entities[slot] == e;
+    }
+    void getJacobian(int slot, Matrix3x3& J) const
+    {
+      get(jacobians, slot, J);
+    }
+    void getJacobianInverse(int slot, Matrix3x3& J) const
+    {
+      get(inverses, slot, J);
+    }
+    double getDV(int slot) const {return dvs[slot];}
+    bool hasNormals() const {return !normals.empty();}
+    void getNormal(int slot, int side, Vector3& n) const
+    {
+      for (int j = 0; j < 3; ++j)
+        n[j] = normals[(side * 3 + j) * size + slot];
+    }
+    void destroyTag();
+  private:
+    void get(std::vector<double> const& a, int slot, Matrix3x3& J) const
+    {
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          J[i][j] = a[(i * 3 + j) * size + slot];
+    }
+    Mesh* mesh;
+    MeshTag* tag;
+    int dim;
+    int size;
+    std::vector<MeshEntity*> entities;
+    std::vector<double> jacobians;
+    std::vector<double> inverses;
+    std::vector<double> dvs;
+    std::vector<double> normals;
+};
+
+}//namespace apf
+
+#endif
@@ -369,6 +369,7 @@ class H1Shape: public FieldShape {
     }
     const char* getName() const { return name.c_str(); }
     bool isVectorShape() {return false;}
+    bool canTabulate() {return true;}
     class Vertex : public apf::EntityShape
     {
     public:
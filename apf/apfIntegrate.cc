@@ -647,15 +647,20 @@ void Integrator::process(Mesh* m, int d)
     d = m->getDimension();
   PCU_DEBUG_ASSERT(d<=m->getDimension());
   MeshEntity* entity;
+  MeshElement* e = 0;
   MeshIterator* elements = m->begin(d);
   while ((entity = m->iterate(elements)))
   {
     if ( ! m->isOwned(entity)) continue;
-    MeshElement* e = createMeshElement(m,entity);
+    if (e)
+      resetMeshElement(e,entity);
+    else
+      e = createMeshElement(m,entity);
     this->process(e);
-    destroyMeshElement(e);
   }
   m->end(elements);
+  if (e)
+    destroyMeshElement(e);
   this->parallelReduce(m->getPCU());
 }
 
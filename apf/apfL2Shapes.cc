@@ -185,6 +185,7 @@ class L2ShapeTri: public FieldShape {
     }
     const char* getName() const { return name.c_str(); }
     bool isVectorShape() {return false;}
+    bool canTabulate() {return true;}
     class Triangle : public apf::EntityShape
     {
     public:
@@ -304,6 +305,7 @@ class L2ShapeTet: public FieldShape {
     }
     const char* getName() const { return name.c_str(); }
     bool isVectorShape() {return false;}
+    bool canTabulate() {return true;}
     class Tetrahedron : public apf::EntityShape
     {
     public:
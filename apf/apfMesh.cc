@@ -11,10 +11,12 @@
 #include "apfShape.h"
 #include "apfNumbering.h"
 #include "apfTagData.h"
+#include "apfGeometryCache.h"
 #include <gmi.h>
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <algorithm>
+#include <vector>
 
 namespace apf {
 
@@ -166,11 +168,14 @@ void Mesh::init(FieldShape* s, pcu::PCU *PCUObj)
   baseP->init("coordinates",this,s,data);
   data->init(baseP);
   hasFrozenFields = false;
+  geometryCache = 0;
   pcu_ = PCUObj;
 }
 
 Mesh::~Mesh()
 {
+  /* the entities may be gone already, so the tag is left alone */
+  delete geometryCache;
   delete coordinateField;
 }
 
@@ -435,6 +440,34 @@ void getPeers(Mesh* m, int d, Parts& peers)
   peers.erase(m->getId());
 }
 
+void setPCUNeighbors(Mesh* m)
+{
+  Parts peers;
+  getPeers(m, 0, peers);
+  if (m->hasMatching())
+    for (int d = 0; d < m->getDimension(); ++d) {
+      MeshEntity* e;
+      MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it))) {
+        Matches matches;
+        m->getMatches(e, matches);
+        for (size_t i = 0; i < matches.getSize(); ++i)
+          peers.insert(matches[i].peer);
+      }
+      m->end(it);
+    }
+  /* this rank is always a neighbor, and keeps the array
+     non-null on parts without neighbors */
+  peers.insert(m->getPCU()->Self());
+  std::vector<int> ranks(peers.begin(), peers.end());
+  m->getPCU()->Neighbors(&ranks[0], ranks.size());
+}
+
+void clearPCUNeighbors(Mesh* m)
+{
+  m->getPCU()->Neighbors(nullptr, 0);
+}
+
 static bool residesOn(Mesh* m, MeshEntity* e, int part)
 {
   Parts residence;
@@ -729,12 +762,14 @@ int countEntitiesOfType(Mesh* m, int type)
 
 void Mesh::setCoordinateField(Field* field)
 {
+  uncacheGeometry(this);
   delete coordinateField;
   coordinateField = field;
 }
 
 void Mesh::changeShape(FieldShape* newShape, bool project)
 {
+  uncacheGeometry(this);
   Field* oldCoordinateField = coordinateField;
   std::string name = oldCoordinateField->getName();
   VectorField* newCoordinateField = new VectorField();
@@ -35,6 +35,7 @@ class MeshIterator;
 class MeshTag;
 
 class ModelEntity;
+class GeometryCache;
 
 /** \brief Remote copy container.
   \details the key is the part id, the value
@@ -361,6 +362,13 @@ class Mesh
       \returns an estimate of how many bytes are needed
       to store an entity of (type) */
     virtual double getElementBytes(int) {return 1.0;}
+    /** \brief index of an entity among those of its type
+      \details meshes that keep each type in an array override this
+      so per-entity tables can be plain arrays. Indices need not be
+      contiguous, but they change when entities are created, destroyed
+      or reordered.
+      \returns the index of (e), or -1 if this mesh has no such index */
+    virtual int getTypeIndex(MeshEntity*) {return -1;}
     /** \brief associate a field with this mesh
       \details most users don't need this, functions in apf.h
                automatically call it */
@@ -401,6 +409,8 @@ class Mesh
     void switchPCU(pcu::PCU *newPCU);
     /** \brief true if any associated fields use array storage */
     bool hasFrozenFields;
+    /** \brief the cached geometric factors, see apf::cacheGeometry */
+    GeometryCache* geometryCache;
   protected:
     Field* coordinateField;
     std::vector<Field*> fields;
@@ -560,6 +570,18 @@ extern int const pyramid_tri_verts[4][3];
 /** \brief scan the part for [vtx|edge|face]-adjacent part ids */
 void getPeers(Mesh* m, int d, Parts& peers);
 
+/** \brief restrict PCU phases of the mesh to its part neighbors
+  \details the parts which share or match entities with this part
+  become the neighbors of m->getPCU(), see pcu::PCU::Neighbors.
+  Exchanges among copies such as apf::synchronize then end without
+  a collective. Every part must call this, and call
+  apf::clearPCUNeighbors before anything that may talk to other
+  parts, like migration. */
+void setPCUNeighbors(Mesh* m);
+
+/** \brief undo apf::setPCUNeighbors */
+void clearPCUNeighbors(Mesh* m);
+
 /** \brief find pointer (e) in array (a) of length (n)
   \returns -1 if not found, otherwise i such that a[i] = e */
 int findIn(MeshEntity** a, int n, MeshEntity* e);
@@ -582,6 +604,31 @@ void unfreezeFields(Mesh* m);
   \details see apf::freezeField */
 void freezeFields(Mesh* m);
 
+/** \brief cache the geometric factors of straight-sided simplices
+  \details on a mesh with linear coordinates, the Jacobian of every
+  triangle and tetrahedron is constant. This computes, for each of
+  the elements of the mesh dimension, the Jacobian, its inverse
+  and the differential volume once, and optionally the outward unit
+  normals of its sides, and keeps them in arrays on the mesh.
+  MeshElements read them instead of recomputing them at every point.
+  The cache is dropped by any change of coordinates, entity creation
+  or destruction, reordering or change of the coordinate field.
+  Meshes of other shapes are left without a cache.
+  \param normals also cache the normals, see apf::getCachedNormal */
+void cacheGeometry(Mesh* m, bool normals = false);
+
+/** \brief drop the cache made by apf::cacheGeometry, if any */
+void uncacheGeometry(Mesh* m);
+
+/** \brief returns true if apf::cacheGeometry is in effect */
+bool hasCachedGeometry(Mesh* m);
+
+/** \brief get the outward unit normal of side i of element e
+  \details sides follow the downward order of e. Within a
+  triangle, the normals of its edges lie in its plane.
+  \returns false if the normals of e are not cached */
+bool getCachedNormal(Mesh* m, MeshEntity* e, int i, Vector3& n);
+
 /** \brief count the number of mesh entities classified on a model entity */
 int countEntitiesOn(Mesh* m, ModelEntity* me, int dim);
 
@@ -66,11 +66,14 @@ class Mesh2 : public Mesh
   all at once. see apf::Mesh2::createVert for a more minimal interface */
     MeshEntity* createVertex(ModelEntity* c, Vector3 const& point,
         Vector3 const& param);
-/** \brief require that no fields are stored in arrays */
+/** \brief require that no fields are stored in arrays
+  \details this also drops the cache of apf::cacheGeometry */
     void requireUnfrozen()
     {
       if (hasFrozenFields)
         unfreezeFields(this);
+      if (geometryCache)
+        uncacheGeometry(this);
     }
 /** \brief Underlying implementation of apf::Mesh2::createVert */
     virtual MeshEntity* createVert_(ModelEntity* c) = 0;
@@ -11,6 +11,7 @@
 #include <pcu_util.h>
 #include <lionPrint.h>
 #include <cstdlib>
+#include <vector>
 
 namespace apf {
 
@@ -378,31 +379,27 @@ static void packTags(
     DynamicArray<MeshTag*>& tags)
 {
   size_t total = tags.getSize();
-  size_t n = 0;
+  std::vector<size_t> has;
   for (size_t i=0; i < total; ++i)
     if (m->hasTag(e,tags[i]))
-      ++n;
-  m->getPCU()->Pack(to,n);
-  for (size_t i=0; i < total; ++i)
+      has.push_back(i);
+  m->getPCU()->PackSized(to,has.data(),has.size());
+  for (size_t j=0; j < has.size(); ++j)
   {
-    MeshTag* tag = tags[i];
-    if (m->hasTag(e,tag))
+    MeshTag* tag = tags[has[j]];
+    int type = m->getTagType(tag);
+    int size = m->getTagSize(tag);
+    if (type == Mesh2::DOUBLE)
     {
-      m->getPCU()->Pack(to,i);
-      int type = m->getTagType(tag);
-      int size = m->getTagSize(tag);
-      if (type == Mesh2::DOUBLE)
-      {
-        DynamicArray<double> d(size);
-        m->getDoubleTag(e,tag,&(d[0]));
-        m->getPCU()->Pack(to,&(d[0]),size*sizeof(double));
-      }
-      if (type == Mesh2::INT)
-      {
-        DynamicArray<int> d(size);
-        m->getIntTag(e,tag,&(d[0]));
-        m->getPCU()->Pack(to,&(d[0]),size*sizeof(int));
-      }
+      DynamicArray<double> d(size);
+      m->getDoubleTag(e,tag,&(d[0]));
+      m->getPCU()->PackArray(to,&(d[0]),size);
+    }
+    if (type == Mesh2::INT)
+    {
+      DynamicArray<int> d(size);
+      m->getIntTag(e,tag,&(d[0]));
+      m->getPCU()->PackArray(to,&(d[0]),size);
     }
   }
 }
@@ -415,29 +412,27 @@ void packRemotes(
 {
   Copies remotes;
   m->getRemotes(e,remotes);
-  size_t n = remotes.size();
-  m->getPCU()->Pack(to,n);
+  std::vector<int> peers;
+  std::vector<MeshEntity*> copies;
+  peers.reserve(remotes.size());
+  copies.reserve(remotes.size());
   APF_ITERATE(Copies,remotes,rit)
   {
-    int p=rit->first;
-    MeshEntity* remote = rit->second;
-    m->getPCU()->Pack(to,p);
-    m->getPCU()->Pack(to,remote);
+    peers.push_back(rit->first);
+    copies.push_back(rit->second);
   }
+  m->getPCU()->PackSized(to,peers.data(),peers.size());
+  m->getPCU()->PackArray(to,copies.data(),copies.size());
 }
 
 void unpackRemotes(Mesh2* m, MeshEntity* e)
 {
-  size_t n;
-  m->getPCU()->Unpack(n);
-  for (size_t i=0; i < n; ++i)
-  {
-    int p;
-    m->getPCU()->Unpack(p);
-    MeshEntity* r;
-    m->getPCU()->Unpack(r);
-    m->addRemote(e, p, r);
-  }
+  std::vector<int> peers;
+  m->getPCU()->UnpackSized(peers);
+  std::vector<MeshEntity*> copies(peers.size());
+  m->getPCU()->UnpackArray(copies.data(),copies.size());
+  for (size_t i=0; i < peers.size(); ++i)
+    m->addRemote(e, peers[i], copies[i]);
 }
 
 void unpackTags(
@@ -445,27 +440,25 @@ void unpackTags(
     MeshEntity* e,
     DynamicArray<MeshTag*>& tags)
 {
-  size_t n;
-  m->getPCU()->Unpack(n);
-  PCU_ALWAYS_ASSERT_VERBOSE(n<=tags.size(),
+  std::vector<size_t> has;
+  m->getPCU()->UnpackSized(has);
+  PCU_ALWAYS_ASSERT_VERBOSE(has.size()<=tags.size(),
       "A tag was created that does not exist on all processes.");
-  for (size_t t=0; t < n; ++t)
+  for (size_t t=0; t < has.size(); ++t)
   {
-    size_t i;
-    m->getPCU()->Unpack(i);
-    MeshTag* tag = tags[i];
+    MeshTag* tag = tags[has[t]];
     int type = m->getTagType(tag);
     int size = m->getTagSize(tag);
     if (type == Mesh2::DOUBLE)
     {
       DynamicArray<double> d(size);
-      m->getPCU()->Unpack(&(d[0]),size*sizeof(double));
+      m->getPCU()->UnpackArray(&(d[0]),size);
       m->setDoubleTag(e,tag,&(d[0]));
     }
     if (type == Mesh2::INT)
     {
       DynamicArray<int> d(size);
-      m->getPCU()->Unpack(&(d[0]),size*sizeof(int));
+      m->getPCU()->UnpackArray(&(d[0]),size);
       m->setIntTag(e,tag,&(d[0]));
     }
   }
@@ -548,18 +541,21 @@ static void echoRemotes(
     Mesh2* m,
     EntityVector& received)
 {
-  APF_ITERATE(EntityVector,received,it)
+  /* unpackEntity() stored the identity of the
+     sender as the only remote copy so we could use
+     it here to echo copies back to their sender */
+  std::vector<Copy> senders(received.size());
+  for (size_t i = 0; i < received.size(); ++i)
   {
-    MeshEntity* entity = *it;
-    /* unpackEntity() stored the identity of the
-       sender as the only remote copy so we could use
-       it here to echo copies back to their sender */
     Copies temp;
-    m->getRemotes(entity,temp);
-    int from = temp.begin()->first;
-    MeshEntity* sender = temp.begin()->second;
-    m->getPCU()->Pack(from,sender);
-    m->getPCU()->Pack(from,entity);
+    m->getRemotes(received[i],temp);
+    senders[i] = Copy(temp.begin()->first, temp.begin()->second);
+    m->getPCU()->Count(senders[i].peer, 2 * sizeof(MeshEntity*));
+  }
+  for (size_t i = 0; i < received.size(); ++i)
+  {
+    MeshEntity* pair[2] = {senders[i].entity, received[i]};
+    m->getPCU()->Pack(senders[i].peer, pair);
   }
 }
 
@@ -524,6 +524,7 @@ class Nedelec: public FieldShape {
     }
     const char* getName() const { return name.c_str(); }
     bool isVectorShape() {return true;}
+    bool canTabulate() {return true;}
     class Vertex : public apf::EntityShape
     {
     public:
@@ -55,6 +55,11 @@ bool FieldShape::isVectorShape()
   return false;
 }
 
+bool FieldShape::canTabulate()
+{
+  return false;
+}
+
 void FieldShape::registerSelf(const char* name_)
 {
   std::string name = name_;
@@ -93,6 +98,7 @@ class Linear : public FieldShape
   public:
     Linear() { registerSelf(apf::Linear::getName()); }
     const char* getName() const { return "Linear"; }
+    bool canTabulate() {return true;}
     class Vertex : public EntityShape
     {
       public:
@@ -554,6 +560,7 @@ class LagrangeQuadratic : public QuadraticBase
   public:
     LagrangeQuadratic() { registerSelf(apf::LagrangeQuadratic::getName()); }
     const char* getName() const {return "Lagrange Quadratic";}
+    bool canTabulate() {return true;}
     class Quad : public EntityShape
     {
       public:
@@ -658,6 +665,7 @@ class SerendipityQuadratic : public QuadraticBase
   public:
     SerendipityQuadratic() { registerSelf(apf::SerendipityQuadratic::getName()); }
     const char* getName() const {return "Serendipity Quadratic";}
+    bool canTabulate() {return true;}
     class Quad : public EntityShape
     {
     public:
@@ -733,6 +741,7 @@ class LagrangeCubic : public FieldShape
   public:
     LagrangeCubic() { registerSelf(apf::LagrangeCubic::getName()); }
     const char* getName() const { return "Lagrange Cubic"; }
+    bool canTabulate() {return true;}
     class Vertex : public EntityShape
     {
       public:
@@ -1023,6 +1032,7 @@ class Constant : public FieldShape
     {
       return name.c_str();
     }
+    bool canTabulate() {return true;}
     class Element : public EntityShape
     {
       public:
@@ -120,6 +120,12 @@ class FieldShape
     virtual void getNodeTangent(int type, int node, Vector3& t);
 /** \brief Returns true if the shape functions are vectors */
     virtual bool isVectorShape();
+/** \brief Returns true if the shape functions depend only on the
+           parent element coordinates
+  \details such shapes ignore the mesh and entity given to
+  their EntityShape, so their values at integration points
+  are computed once and reused, see apf::getShapeTable */
+    virtual bool canTabulate();
 /** \brief Get a unique string for this shape function scheme */
     virtual const char* getName() const = 0;
     void registerSelf(const char* name);
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#include "apfShapeTable.h"
+#include "apfShape.h"
+#include "apfIntegrate.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace apf {
+
+ShapeTable::ShapeTable(EntityShape* s, Integration const* r, int k)
+{
+  nodes = s->countNodes();
+  points = r->countPoints();
+  if (k == VALUES)
+    values.resize(points * nodes);
+  else
+    vectors.resize(points * nodes);
+  /* the shapes that can be tabulated ignore the mesh and entity */
+  NewArray<double> v;
+  NewArray<Vector3> g(nodes);
+  for (int p = 0; p < points; ++p) {
+    Vector3 const& xi = r->getPoint(p)->param;
+    switch (k) {
+      case VALUES:
+        s->getValues(0, 0, xi, v);
+        break;
+      case GRADIENTS:
+        s->getLocalGradients(0, 0, xi, g);
+        break;
+      case VECTORS:
+        s->getVectorValues(0, 0, xi, g);
+        break;
+      case CURLS:
+        s->getLocalVectorCurls(0, 0, xi, g);
+        break;
+      default:
+        fail("ShapeTable: bad kind");
+    }
+    for (int n = 0; n < nodes; ++n)
+      if (k == VALUES)
+        values[p * nodes + n] = v[n];
+      else
+        vectors[p * nodes + n] = g[n];
+  }
+}
+
+typedef std::tuple<FieldShape*, int, Integration const*, int> TableKey;
+typedef std::map<TableKey, std::unique_ptr<ShapeTable> > TableMap;
+
+ShapeTable const* getShapeTable(FieldShape* s, int type,
+    Integration const* r, int k)
+{
+  if (!s->canTabulate())
+    return 0;
+  static std::mutex lock;
+  static TableMap tables;
+  std::lock_guard<std::mutex> guard(lock);
+  std::unique_ptr<ShapeTable>& t = tables[TableKey(s, type, r, k)];
+  if (!t)
+    t.reset(new ShapeTable(s->getEntityShape(type), r, k));
+  return t.get();
+}
+
+}//namespace apf
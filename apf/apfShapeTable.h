@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Scientific Computation Research Center
+ *
+ * This work is open source software, licensed under the terms of the
+ * BSD license as described in the LICENSE file in the top-level directory.
+ */
+
+#ifndef APFSHAPETABLE_H
+#define APFSHAPETABLE_H
+
+#include "apfVector.h"
+#include <vector>
+
+namespace apf {
+
+class FieldShape;
+class EntityShape;
+class Integration;
+
+/** \brief Shape functions tabulated at the points of an integration rule
+  \details the table holds one quantity of every node at every point,
+  in one contiguous array with the nodes of a point next to each other.
+  Tables are made once per (FieldShape, element type, Integration, kind)
+  and never change after that, so they may be read by many threads. */
+class ShapeTable
+{
+  public:
+    /** \brief the quantity held by a table */
+    enum Kind {
+      /** \brief scalar shape function values */
+      VALUES,
+      /** \brief gradients with respect to parent coordinates */
+      GRADIENTS,
+      /** \brief vector shape function values before the Piola map */
+      VECTORS,
+      /** \brief curls of vector shape functions in parent coordinates */
+      CURLS,
+      KINDS
+    };
+    ShapeTable(EntityShape* s, Integration const* r, int k);
+    int countNodes() const {return nodes;}
+    int countPoints() const {return points;}
+    /** \brief the node values at point p, for a VALUES table */
+    double const* getValues(int p) const {return &values[p * nodes];}
+    /** \brief the node vectors at point p, for the other kinds */
+    Vector3 const* getVectors(int p) const {return &vectors[p * nodes];}
+  private:
+    int nodes;
+    int points;
+    std::vector<double> values;
+    std::vector<Vector3> vectors;
+};
+
+/** \brief get the table of a shape at the points of a rule
+  \param type select from apf::Mesh::Type
+  \param k select from apf::ShapeTable::Kind
+  \returns null if the shape functions depend on more than the
+           parent coordinates, see apf::FieldShape::canTabulate */
+ShapeTable const* getShapeTable(FieldShape* s, int type,
+    Integration const* r, int k);
+
+}//namespace apf
+
+#endif
@@ -7,19 +7,34 @@
 
 #include "apfVectorElement.h"
 #include "apfVectorField.h"
+#include "apfGeometryCache.h"
 
 namespace apf {
 
 VectorElement::VectorElement(VectorField* f, MeshEntity* e):
-  ElementOf<Vector3>(f,e)
+  ElementOf<Vector3>(f,e),
+  geometrySlot(-1)
 {
 }
 
 VectorElement::VectorElement(VectorField* f, VectorElement* p):
-  ElementOf<Vector3>(f,p)
+  ElementOf<Vector3>(f,p),
+  geometrySlot(-1)
 {
 }
 
+/* the cache of apf::cacheGeometry, if it has this element
+   and this element is over the mesh coordinates */
+GeometryCache* VectorElement::getGeometry()
+{
+  GeometryCache* c = mesh->geometryCache;
+  if (!c || field != mesh->getCoordinateField())
+    return 0;
+  if (!c->has(geometrySlot, entity))
+    geometrySlot = c->find(entity);
+  return geometrySlot < 0 ? 0 : c;
+}
+
 double VectorElement::div(Vector3 const& xi)
 {
   NewArray<Vector3> globalGradients;
@@ -60,8 +75,10 @@ void VectorElement::grad(Vector3 const& xi, Matrix3x3& g)
 
 void VectorElement::getJacobian(Vector3 const& xi, Matrix3x3& J)
 {
+  if (GeometryCache* c = getGeometry())
+    return c->getJacobian(geometrySlot, J);
   NewArray<Vector3> localGradients;
-  this->shape->getLocalGradients(mesh, entity, xi, localGradients);
+  getLocalGradients(xi, localGradients);
   gradHelper(localGradients,J);
 }
 
@@ -91,8 +108,19 @@ double getJacobianDeterminant(Matrix3x3 const& J, int dimension)
   return J[0].getLength();
 }
 
+void VectorElement::getJacobianInv(Vector3 const& xi, Matrix3x3& Jinv)
+{
+  if (GeometryCache* c = getGeometry())
+    return c->getJacobianInverse(geometrySlot, Jinv);
+  Matrix3x3 J;
+  getJacobian(xi, J);
+  Jinv = getJacobianInverse(J, getDimension());
+}
+
 double VectorElement::getDV(Vector3 const& xi)
 {
+  if (GeometryCache* c = getGeometry())
+    return c->getDV(geometrySlot);
   Matrix3x3 J;
   getJacobian(xi,J);
   return getJacobianDeterminant(J,getDimension());
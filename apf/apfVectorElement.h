@@ -14,6 +14,7 @@
 namespace apf {
 
 class VectorField;
+class GeometryCache;
 
 class VectorElement : public ElementOf<Vector3>
 {
@@ -25,8 +26,12 @@ class VectorElement : public ElementOf<Vector3>
     void grad(Vector3 const& xi, Matrix3x3& g);
     void curl(Vector3 const& xi, Vector3& c);
     void getJacobian(Vector3 const& xi, Matrix3x3& J);
+    void getJacobianInv(Vector3 const& xi, Matrix3x3& Jinv);
     double getDV(Vector3 const& xi);
     void gradHelper(NewArray<Vector3>& nodalGradients, Matrix3x3& g);
+  private:
+    GeometryCache* getGeometry();
+    int geometrySlot;
 };
 
 double getJacobianDeterminant(Matrix3x3 const& J, int dimension);
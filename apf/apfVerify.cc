@@ -416,24 +416,26 @@ static void sendCoords(Mesh* m, MeshEntity* e)
   m->getPoint(e, 0, x);
   Vector3 p(0,0,0);
   m->getParam(e, p);
+  double xp[6];
+  x.toArray(xp);
+  p.toArray(xp + 3);
   Copies r;
   m->getRemotes(e, r);
   APF_ITERATE(Copies, r, it)
   {
     m->getPCU()->Pack(it->first, it->second);
-    m->getPCU()->Pack(it->first, x);
-    m->getPCU()->Pack(it->first, p);
+    m->getPCU()->PackArray(it->first, xp, 6);
   }
 }
 
 static bool receiveCoords(Mesh* m)
 {
   MeshEntity* e;
-  Vector3 ox;
-  Vector3 op;
+  double xp[6];
   m->getPCU()->Unpack(e);
-  m->getPCU()->Unpack(ox);
-  m->getPCU()->Unpack(op);
+  m->getPCU()->UnpackArray(xp, 6);
+  Vector3 ox(xp);
+  Vector3 op(xp + 3);
   Vector3 x;
   Vector3 p(0,0,0);
   m->getPoint(e, 0, x);
@@ -11,6 +11,9 @@ set(APF_SOURCES
   apf.cc
   apfCavityOp.cc
   apfElement.cc
+  apfShapeTable.cc
+  apfElementBlock.cc
+  apfGeometryCache.cc
   apfField.cc
   apfFieldOf.cc
   apfGradientByVolume.cc
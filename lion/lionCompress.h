@@ -10,6 +10,11 @@ void compress(void* dest, unsigned long& destLen,
 
 unsigned long compressBound(unsigned long sourceLen);
 
+/* destLen is the capacity of dest on input and
+   the decompressed size on output, zero on failure */
+void uncompress(void* dest, unsigned long& destLen,
+    const void* source, unsigned long sourceLen);
+
 }
 
 #endif
@@ -22,5 +22,15 @@ unsigned long compressBound(unsigned long sourceLen)
 	abort();
 }
 
+void uncompress(void* dest, unsigned long& destLen,
+    const void* source, unsigned long sourceLen)
+{
+  (void) dest;
+  (void) destLen;
+  (void) source;
+  (void) sourceLen;
+  abort();
+}
+
 }
 
@@ -17,4 +17,14 @@ unsigned long compressBound(unsigned long sourceLen)
 	return ::compressBound(sourceLen);
 }
 
+void uncompress(void* dest, unsigned long& destLen,
+    const void* source, unsigned long sourceLen)
+{
+  uLongf len = destLen;
+  if (::uncompress((Bytef*)dest, &len, (const Bytef*)source, sourceLen)
+      != Z_OK)
+    len = 0;
+  destLen = len;
+}
+
 }
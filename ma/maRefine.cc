@@ -18,6 +18,7 @@
 #include "maSnap.h"
 #include "maLayer.h"
 #include <apf.h>
+#include <apfMDS.h>
 #include <pcu_util.h>
 
 namespace ma {
@@ -57,6 +58,18 @@ void allocateRefine(Refine* r, int counts[4])
     r->toSplit[d].setSize(counts[d]);
 }
 
+/* upper bounds on the entities created by the simplex templates,
+   so that MDS storage is resized once instead of during splitting */
+static void reserveRefine(Mesh* m, int counts[4])
+{
+  std::size_t n[4];
+  n[0] = m->count(0) + counts[1];
+  n[1] = m->count(1) + 2 * counts[1] + 3 * counts[2] + counts[3];
+  n[2] = m->count(2) + 4 * counts[2] + 8 * counts[3];
+  n[3] = m->count(3) + 8 * counts[3];
+  apf::reserveMdsMesh(m, n);
+}
+
 void addEdgePostAllocation(Refine* refiner, Entity* e, int counts[4])
 {
   Adapt* a = refiner->adapt;
@@ -105,6 +118,7 @@ void addAllMarkedEdges(Refine* r)
       addEdgePreAllocation(r,e,n);
   m->end(it);
   allocateRefine(r,n);
+  reserveRefine(m,n);
   n[1]=n[2]=n[3]=0;
   it = m->begin(1);
   while ((e = m->iterate(it)))
@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <limits>
 #include <deque>
+#include <algorithm>
 
 extern "C" {
 
@@ -320,14 +321,23 @@ class MeshMDS : public Mesh2
     {
       mds_set s;
       mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
+      int d = mds_dim[mds_type(id)] + 1;
+      if (mds_frozen_adjacent(&(mesh->mds),id,d,&s.n))
+        return s.n;
+      mds_get_adjacent(&(mesh->mds),id,d,&s);
       return s.n;
     }
     MeshEntity* getUpward(MeshEntity* e, int i)
     {
       mds_set s;
       mds_id id = fromEnt(e);
-      mds_get_adjacent(&(mesh->mds),id,mds_dim[mds_type(id)] + 1,&s);
+      int d = mds_dim[mds_type(id)] + 1;
+      mds_id* frozen = mds_frozen_adjacent(&(mesh->mds),id,d,&s.n);
+      if (frozen) {
+        PCU_ALWAYS_ASSERT(i < s.n);
+        return toEnt(frozen[i]);
+      }
+      mds_get_adjacent(&(mesh->mds),id,d,&s);
       PCU_ALWAYS_ASSERT(i < s.n);
       return toEnt(s.e[i]);
     }
@@ -372,6 +382,10 @@ class MeshMDS : public Mesh2
     {
       return mds2apf(mds_type(fromEnt(e)));
     }
+    int getTypeIndex(MeshEntity* e)
+    {
+      return mds_index(fromEnt(e));
+    }
     void getRemotes(MeshEntity* e, Copies& remotes)
     {
       if (!isShared(e))
@@ -571,6 +585,7 @@ class MeshMDS : public Mesh2
     void acceptChanges()
     {
       updateOwners(this, pmodel);
+      mds_compact_copies(mesh);
     }
 
     void migrate(Migration* plan)
@@ -965,11 +980,53 @@ void reorderMdsMesh(Mesh2* mesh, MeshTag* t)
   } else {
     vert_nums = mds_number_verts_bfs(m->mesh);
   }
+  uncacheGeometry(mesh);
   m->mesh = mds_reorder(mesh->getPCU()->GetCHandle(), m->mesh, 0, vert_nums);
+  if (mesh->hasFrozenFields)
+    reorderFrozenFields(mesh);
   if (!mesh->getPCU()->Self())
     lion_oprint(1,"mesh reordered in %f seconds\n", pcu::Time()-t0);
 }
 
+void reorderMdsMesh(Mesh2* mesh, MdsOrder order)
+{
+  double t0 = pcu::Time();
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  mds_tag* nums;
+  if (order == MDS_ORDER_HILBERT)
+    nums = mds_number_sfc(m->mesh, MDS_HILBERT);
+  else if (order == MDS_ORDER_MORTON)
+    nums = mds_number_sfc(m->mesh, MDS_MORTON);
+  else
+    nums = mds_number_verts_bfs(m->mesh);
+  uncacheGeometry(mesh);
+  m->mesh = mds_reorder(mesh->getPCU()->GetCHandle(), m->mesh, 0, nums);
+  if (mesh->hasFrozenFields)
+    reorderFrozenFields(mesh);
+  double t1 = pcu::Time();
+  mds_order_quality q;
+  mds_measure_order(m->mesh, &q);
+  long bandwidth = mesh->getPCU()->Max<long>(q.bandwidth);
+  double misses = mesh->getPCU()->Add<double>(q.misses * q.elements);
+  double elements = mesh->getPCU()->Add<double>(q.elements);
+  if (!mesh->getPCU()->Self())
+    lion_oprint(1,"mesh reordered in %f seconds, max bandwidth %ld, "
+        "%f misses per element\n", t1 - t0, bandwidth,
+        elements ? misses / elements : 0);
+}
+
+MdsOrderQuality measureMdsOrder(Mesh2* mesh)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(mesh);
+  mds_order_quality q;
+  mds_measure_order(m->mesh, &q);
+  MdsOrderQuality out;
+  out.bandwidth = q.bandwidth;
+  out.meanBandwidth = q.mean_bandwidth;
+  out.missesPerElement = q.misses;
+  return out;
+}
+
 
 Mesh2* expandMdsMesh(Mesh2* m, gmi_model* g, int inputPartCount, pcu::PCU *expandedPCU)
 {
@@ -1036,7 +1093,15 @@ bool alignMdsMatches(Mesh2* in)
 bool alignMdsRemotes(Mesh2* in)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
-  return mds_align_remotes(in->getPCU()->GetCHandle(), m->mesh);
+  bool changed = mds_align_remotes(in->getPCU()->GetCHandle(), m->mesh);
+  mds_compact_copies(m->mesh);
+  return changed;
+}
+
+bool isMdsRemotesCompact(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  return m->mesh->remotes.compact;
 }
 
 void deriveMdsModel(Mesh2* in)
@@ -1250,6 +1315,97 @@ void derive2DMdlFromManifold(Mesh2* mesh, bool* isModelVert,
   mesh->destroyTag(vIDTag);
 }
 
+void reserveMdsMesh(Mesh2* in, std::size_t const counts[4])
+{
+  MeshMDS* m = dynamic_cast<MeshMDS*>(in);
+  if (!m)
+    return;
+  mds* mds = &(m->mesh->mds);
+  mds_id cap[MDS_TYPES];
+  for (int t = 0; t < MDS_TYPES; ++t)
+    cap[t] = mds->cap[t];
+  for (int d = 0; d <= mds->d; ++d) {
+    mds_id n = m->count(d);
+    if (counts[d] <= static_cast<std::size_t>(n))
+      continue;
+    mds_id extra = counts[d] - n;
+    /* split the extra space between the types of this dimension
+       according to how many of each there are now, and give it all
+       to the simplex if there are none yet */
+    for (int t = 0; t < MDS_TYPES; ++t) {
+      if (mds_dim[t] != d)
+        continue;
+      if (n)
+        cap[t] = mds->n[t] + (extra * double(mds->n[t])) / n;
+      else if (t == apf2mds(Mesh::simplexTypes[d]))
+        cap[t] = extra;
+    }
+  }
+  mds_apf_reserve(m->mesh, cap);
+}
+
+void setMdsGrowthFactor(Mesh2* in, double factor)
+{
+  PCU_ALWAYS_ASSERT(factor > 1);
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  m->mesh->mds.growth = factor;
+}
+
+void getMdsRanges(Mesh2* in, int dim, int n, std::vector<MdsRange>& ranges)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds* mds = &(m->mesh->mds);
+  ranges.clear();
+  mds_id total = 0;
+  for (int t = 0; t < MDS_TYPES; ++t)
+    if (mds_dim[t] == dim)
+      total += mds->end[t];
+  if (n < 1)
+    n = 1;
+  mds_id size = (total + n - 1) / n;
+  if (size < 1)
+    size = 1;
+  for (int t = 0; t < MDS_TYPES; ++t) {
+    if (mds_dim[t] != dim)
+      continue;
+    for (mds_id i = 0; i < mds->end[t]; i += size) {
+      MdsRange r;
+      r.type = t;
+      r.begin = i;
+      r.end = std::min(i + size, mds->end[t]);
+      ranges.push_back(r);
+    }
+  }
+}
+
+MeshEntity* iterateMdsRange(Mesh2* in, MdsRange& r)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_id* status = m->mesh->mds.free[r.type];
+  for (; r.begin < r.end; ++r.begin)
+    if (status[r.begin] == MDS_LIVE)
+      return toEnt(mds_identify(r.type, r.begin++));
+  return 0;
+}
+
+void freezeMdsAdjacency(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_freeze(&(m->mesh->mds));
+}
+
+void unfreezeMdsAdjacency(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds_unfreeze(&(m->mesh->mds));
+}
+
+bool isMdsAdjacencyFrozen(Mesh2* in)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  return m->mesh->mds.frozen;
+}
+
 void changeMdsDimension(Mesh2* in, int d)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
@@ -1284,6 +1440,116 @@ MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index)
   return 0;
 }
 
+static void checkMdsCompact(mds* mds, int t)
+{
+  if (mds->n[t] != mds->end[t]) {
+    lion_eprint(1, "MDS arrays of type %d have gaps, "
+        "please call apf::reorderMdsMesh first\n", t);
+    abort();
+  }
+}
+
+/* copies tag data for the entities with dimension-unique
+   indices [first, first + n), see apf::getMdsIndex */
+static void accessMdsTagRange(Mesh2* in, MeshTag* t, int dim,
+    int first, int n, char* data, bool isSet)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds* mds = &(m->mesh->mds);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  for (int type = 0; type < MDS_TYPES && n > 0; ++type) {
+    if (mds_dim[type] != dim)
+      continue;
+    if (first >= mds->n[type]) {
+      first -= mds->n[type];
+      continue;
+    }
+    checkMdsCompact(mds, type);
+    int k = std::min(n, mds->n[type] - first);
+    for (int i = first; i < first + k; ++i) {
+      mds_id e = mds_identify(type, i);
+      if (isSet && !mds_has_tag(tag, e))
+        mds_give_tag(tag, mds, e);
+      if (!isSet && !mds_has_tag(tag, e)) {
+        lion_eprint(1, "expected tag \"%s\" on entity type %d\n",
+            tag->name, mds2apf(type));
+        abort();
+      }
+    }
+    char* p = tag->data[type] + size_t(tag->bytes) * first;
+    size_t bytes = size_t(tag->bytes) * k;
+    if (isSet)
+      memcpy(p, data, bytes);
+    else
+      memcpy(data, p, bytes);
+    data += bytes;
+    n -= k;
+    first = 0;
+  }
+  PCU_ALWAYS_ASSERT(n == 0);
+}
+
+void getMdsDoubleTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, double* data)
+{
+  PCU_ALWAYS_ASSERT(in->getTagType(tag) == Mesh::DOUBLE);
+  accessMdsTagRange(in, tag, dim, first, n,
+      reinterpret_cast<char*>(data), false);
+}
+
+void setMdsDoubleTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, double const* data)
+{
+  PCU_ALWAYS_ASSERT(in->getTagType(tag) == Mesh::DOUBLE);
+  accessMdsTagRange(in, tag, dim, first, n,
+      reinterpret_cast<char*>(const_cast<double*>(data)), true);
+}
+
+void getMdsIntTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, int* data)
+{
+  PCU_ALWAYS_ASSERT(in->getTagType(tag) == Mesh::INT);
+  accessMdsTagRange(in, tag, dim, first, n,
+      reinterpret_cast<char*>(data), false);
+}
+
+void setMdsIntTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, int const* data)
+{
+  PCU_ALWAYS_ASSERT(in->getTagType(tag) == Mesh::INT);
+  accessMdsTagRange(in, tag, dim, first, n,
+      reinterpret_cast<char*>(const_cast<int*>(data)), true);
+}
+
+void getMdsLongTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, long* data)
+{
+  PCU_ALWAYS_ASSERT(in->getTagType(tag) == Mesh::LONG);
+  accessMdsTagRange(in, tag, dim, first, n,
+      reinterpret_cast<char*>(data), false);
+}
+
+void setMdsLongTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, long const* data)
+{
+  PCU_ALWAYS_ASSERT(in->getTagType(tag) == Mesh::LONG);
+  accessMdsTagRange(in, tag, dim, first, n,
+      reinterpret_cast<char*>(const_cast<long*>(data)), true);
+}
+
+void* getMdsTagArray(Mesh2* in, MeshTag* t, int type)
+{
+  MeshMDS* m = static_cast<MeshMDS*>(in);
+  mds* mds = &(m->mesh->mds);
+  mds_tag* tag = reinterpret_cast<mds_tag*>(t);
+  int mt = apf2mds(type);
+  checkMdsCompact(mds, mt);
+  for (mds_id i = 0; i < mds->n[mt]; ++i)
+    if (!mds_has_tag(tag, mds_identify(mt, i)))
+      mds_give_tag(tag, mds, mds_identify(mt, i));
+  return tag->data[mt];
+}
+
 void disownMdsModel(Mesh2* in)
 {
   MeshMDS* m = static_cast<MeshMDS*>(in);
@@ -31,6 +31,8 @@
   \brief Interface to the compact Mesh Data Structure */
 
 #include <map>
+#include <vector>
+#include <functional>
 //
 // AJP: including apf.h for single define: CGNSBCMap
 // AJP: alternative is to allow common cgns base header
@@ -81,7 +83,11 @@ Mesh2* loadMdsMesh(const char* modelfile, const char* meshfile, pcu::PCU *PCUObj
                   where N is the part number.
                   If the path is "something/", then the
                   file "something/N.smb" will be loaded.
-                  For both of these cases, if the path is
+                  If the path is "something"".psmb", then all
+                  parts are read from the one file "something.psmb"
+                  with collective MPI-IO, or from "somethingK.psmb"
+                  holding parts 4096K to 4096K+4095 with more parts.
+                  For all of these cases, if the path is
                   prepended with "bz2:", then it will be uncompressed
                   using PCU file IO functions.
                   Calling apf::Mesh::writeNative on the
@@ -111,16 +117,61 @@ Mesh2* createMdsMesh(gmi_model* model, Mesh* from, bool reorder=false, bool copy
            each topological type.
            Then all MDS arrays are re-formed in this new order.
            An important side effect of this function is that
-           there are no gaps in the MDS arrays after this */
+           there are no gaps in the MDS arrays after this.
+           Frozen fields stay frozen, their arrays are permuted
+           to the new order by apf::reorderFrozenFields */
 void reorderMdsMesh(Mesh2* mesh, MeshTag* t = 0);
 
+/** \brief orderings offered by apf::reorderMdsMesh */
+enum MdsOrder {
+  /** \brief breadth-first traversal of vertex adjacencies,
+    elements follow their vertices */
+  MDS_ORDER_BFS,
+  /** \brief vertices and elements sorted along a Hilbert
+    curve through their centroids */
+  MDS_ORDER_HILBERT,
+  /** \brief like MDS_ORDER_HILBERT with a Morton (Z-order) curve */
+  MDS_ORDER_MORTON
+};
+
+/** \brief reorder the mesh with one of the built-in orderings
+  \details edges and faces follow the vertex order in all cases.
+  The space filling curve orderings favor locality of element
+  traversal over vertex bandwidth.
+  The resulting apf::MdsOrderQuality is printed
+  along with the timing. */
+void reorderMdsMesh(Mesh2* mesh, MdsOrder order);
+
+/** \brief locality metrics of the current entity order of a part */
+struct MdsOrderQuality
+{
+  /** \brief the largest index difference between the
+    two vertices of an edge, the bandwidth of a vertex matrix */
+  long bandwidth;
+  /** \brief the mean index difference over edges */
+  double meanBandwidth;
+  /** \brief average number of vertices per element that were not
+    used by the previous 64 elements, a proxy for cache misses
+    of element-by-element kernels */
+  double missesPerElement;
+};
+
+/** \brief measure the locality of the order of this part's entities */
+MdsOrderQuality measureMdsOrder(Mesh2* mesh);
+
 Mesh2* repeatMdsMesh(Mesh2* m, gmi_model* g, Migration* plan, int factor, pcu::PCU *PCUObj);
 
 Mesh2* expandMdsMesh(Mesh2* m, gmi_model* g, int inputPartCount, pcu::PCU *expandedPCU);
 /** \brief align the downward adjacencies of matched entities */
 bool alignMdsMatches(Mesh2* in);
-/** \brief align the downward adjacencies of remote copies */
+/** \brief align the downward adjacencies of remote copies
+  \details this also packs the remote copies into a compact table,
+  as migration does when it finishes. */
 bool alignMdsRemotes(Mesh2* in);
+/** \brief return true if the remote copies are in the compact table
+  \details the table is unpacked again by the first change to the
+  remote copies, which remain readable in either form. */
+bool isMdsRemotesCompact(Mesh2* in);
 
 /** \brief build a null model such that apf::verify accepts the mesh.
   \details given an MDS mesh that is (wrongly) classified on a null model,
@@ -183,6 +234,77 @@ void derive2DMdlFromManifold(Mesh2* mesh, bool* isModelVert,
 			     GlobalToVert &globalToVert,
 			     std::map<int, apf::MeshEntity*> &globalToFace);
 
+/** \brief pre-size MDS storage for a known number of entities
+  \param counts for each dimension, the number of entities the
+         mesh should be able to hold before growing its arrays again.
+         Space for a dimension with several entity types is divided
+         according to the current number of each type.
+  \details this resizes the entity, coordinate, classification,
+  remote copy and tag arrays once, instead of in many steps as
+  entities are created. Capacity is never reduced.
+  This does nothing if the mesh is not an MDS mesh. */
+void reserveMdsMesh(Mesh2* in, std::size_t const counts[4]);
+
+/** \brief set the factor by which MDS arrays grow when they are full
+  \details the default is 1.5. Larger factors mean fewer reallocations
+  during heavy refinement at the cost of more unused memory. */
+void setMdsGrowthFactor(Mesh2* in, double factor);
+
+/** \brief a contiguous slice of the MDS storage of one entity type
+  \details ranges may contain gaps left by destroyed entities,
+  apf::iterateMdsRange skips over them. */
+struct MdsRange
+{
+  /** \brief internal MDS type of the entities in this range */
+  int type;
+  /** \brief first storage index, advanced by apf::iterateMdsRange */
+  int begin;
+  /** \brief one past the last storage index */
+  int end;
+};
+
+/** \brief split the storage of entities of one dimension into ranges
+  \param n the desired number of ranges. Each type of that dimension
+            is split separately, so slightly more may be returned.
+  \details ranges are disjoint and together cover all entities
+  of that dimension, so they can be processed concurrently. */
+void getMdsRanges(Mesh2* in, int dim, int n, std::vector<MdsRange>& ranges);
+
+/** \brief return the next entity in the range, or zero when done
+  \details this is the range equivalent of apf::Mesh::iterate */
+MeshEntity* iterateMdsRange(Mesh2* in, MdsRange& r);
+
+/** \brief apply a function to all entities of one dimension using threads
+  \param threads the number of threads to use, including the calling one.
+                  Zero means one per hardware thread.
+  \details the entities are split with apf::getMdsRanges and the ranges
+  are handed out to a pool of threads which persists between calls.
+  The function is called exactly once per entity, in no particular order.
+  It is safe for the function to make read-only queries concurrently:
+  coordinates, adjacencies, tag and field values (getComponents, getPoint,
+  getDownward, getAdjacent, getIntTag, etc.).
+  Anything that modifies the mesh, its tags, fields or numberings
+  is not safe, and neither are PCU calls. */
+void parallelFor(Mesh2* m, int dim,
+    std::function<void(MeshEntity*)> const& f, int threads = 0);
+
+/** \brief store upward adjacencies in compressed arrays
+  \details this builds, for every entity dimension and every higher
+  dimension, a contiguous offsets/values table of upward adjacencies.
+  Until the mesh is modified, upward queries (getUp, getUpward,
+  countUpward, getAdjacent) read from these tables instead of walking
+  the linked lists MDS normally uses.
+  Creating or destroying any entity, changing the dimension,
+  or calling apf::reorderMdsMesh drops the tables automatically,
+  after which this may be called again. */
+void freezeMdsAdjacency(Mesh2* in);
+
+/** \brief drop the tables built by apf::freezeMdsAdjacency */
+void unfreezeMdsAdjacency(Mesh2* in);
+
+/** \brief return true if upward adjacencies are currently frozen */
+bool isMdsAdjacencyFrozen(Mesh2* in);
+
 /** \brief change the dimension of an MDS mesh
   \details this should be called before adding entities of
   dimension higher than the previous mesh dimension
@@ -204,6 +326,46 @@ int getMdsIndex(Mesh2* in, MeshEntity* e);
   so call apf::reorderMdsMesh after any mesh modification. */
 MeshEntity* getMdsEntity(Mesh2* in, int dimension, int index);
 
+/** \brief copy the tag values of a range of entities into an array
+  \param first the apf::getMdsIndex of the first entity
+  \param n the number of entities
+  \param data output of n times the tag size values
+  \details this is the bulk equivalent of apf::Mesh::getDoubleTag,
+  all entities in the range must have the tag.
+  Like apf::getMdsIndex, this only works when the arrays have no gaps,
+  so call apf::reorderMdsMesh after any mesh modification. */
+void getMdsDoubleTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, double* data);
+/** \brief bulk equivalent of apf::Mesh::setDoubleTag,
+  see apf::getMdsDoubleTagRange */
+void setMdsDoubleTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, double const* data);
+/** \brief see apf::getMdsDoubleTagRange */
+void getMdsIntTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, int* data);
+/** \brief see apf::setMdsDoubleTagRange */
+void setMdsIntTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, int const* data);
+/** \brief see apf::getMdsDoubleTagRange */
+void getMdsLongTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, long* data);
+/** \brief see apf::setMdsDoubleTagRange */
+void setMdsLongTagRange(Mesh2* in, MeshTag* tag, int dim,
+    int first, int n, long const* data);
+
+/** \brief direct access to the tag storage of one entity type
+  \param type the apf::Mesh::Type of entities
+  \returns an array holding the tag values of all entities of this type,
+  in apf::getMdsIndex order starting from the first entity of this type.
+  Cast it to the tag's data type; each entity has apf::Mesh::getTagSize
+  values. Reads and writes through it are equivalent to tag calls.
+  \details all entities of this type are given the tag.
+  The array is valid until entities of this type are created
+  or destroyed, or the tag is destroyed.
+  This only works when the arrays have no gaps,
+  so call apf::reorderMdsMesh after any mesh modification. */
+void* getMdsTagArray(Mesh2* in, MeshTag* tag, int type);
+
 Mesh2* loadMdsFromCGNS(PCU_t h, gmi_model* g, const char* filename, CGNSBCMap& cgnsBCMap);
 
 // names of mesh data to read from file: (VERTEX, VelocityX; CellCentre, Pressure)
@@ -0,0 +1,127 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include "apfMDS.h"
+#include <apfMesh2.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace apf {
+
+/* a fixed set of worker threads which all run the same job
+   and then go back to sleep. The calling thread takes part
+   in every job, so a pool of n threads has n - 1 workers. */
+class ThreadPool
+{
+  public:
+    ThreadPool():
+      job(0),
+      participants(0),
+      generation(0),
+      running(0),
+      stopping(false)
+    {
+    }
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+    }
+    void run(int n, std::function<void()> const& f)
+    {
+      std::lock_guard<std::mutex> serial(jobMutex);
+      if (n > 1) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (static_cast<int>(workers.size()) < n - 1)
+          workers.push_back(std::thread(&ThreadPool::work, this,
+                static_cast<int>(workers.size())));
+        job = &f;
+        participants = n - 1;
+        running = n - 1;
+        ++generation;
+        lock.unlock();
+        wake.notify_all();
+      }
+      f();
+      if (n > 1) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (running)
+          done.wait(lock);
+        job = 0;
+      }
+    }
+  private:
+    void work(int index)
+    {
+      unsigned seen = 0;
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        while (!stopping && generation == seen)
+          wake.wait(lock);
+        if (stopping)
+          return;
+        seen = generation;
+        if (index >= participants)
+          continue;
+        std::function<void()> const* f = job;
+        lock.unlock();
+        (*f)();
+        lock.lock();
+        if (!--running)
+          done.notify_one();
+      }
+    }
+    std::vector<std::thread> workers;
+    std::mutex jobMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::function<void()> const* job;
+    int participants;
+    unsigned generation;
+    int running;
+    bool stopping;
+};
+
+static ThreadPool& getPool()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+void parallelFor(Mesh2* m, int dim,
+    std::function<void(MeshEntity*)> const& f, int threads)
+{
+  if (threads < 1)
+    threads = std::thread::hardware_concurrency();
+  if (threads < 1)
+    threads = 1;
+  std::vector<MdsRange> ranges;
+  /* a few ranges per thread smooths out the cost of gaps */
+  getMdsRanges(m, dim, threads * 4, ranges);
+  std::atomic<size_t> next(0);
+  getPool().run(threads, [&]() {
+    for (size_t i = next++; i < ranges.size(); i = next++) {
+      MdsRange r = ranges[i];
+      MeshEntity* e;
+      while ((e = iterateMdsRange(m, r)))
+        f(e);
+    }
+  });
+}
+
+}
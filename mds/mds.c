@@ -276,12 +276,14 @@ void mds_create(struct mds* m, int d, mds_id cap[MDS_TYPES])
   resize(m,zero_cap);
   for (i = 0; i < MDS_TYPES; ++i)
     m->first_free[i] = MDS_NONE;
+  m->growth = 1.5;
 }
 
 void mds_destroy(struct mds* m)
 {
   int i;
   mds_id old_cap[MDS_TYPES];
+  mds_unfreeze(m);
   for (i = 0; i < MDS_TYPES; ++i)
     old_cap[i] = m->cap[i];
   ZERO(m->cap);
@@ -513,10 +515,27 @@ static void grow(struct mds* m, int t)
   mds_id old_cap[MDS_TYPES];
   for (i = 0; i < MDS_TYPES; ++i)
     old_cap[i] = m->cap[i];
-  m->cap[t] = ((old_cap[t] + 2) * 3) / 2;
+  m->cap[t] = (old_cap[t] + 2) * m->growth;
   resize(m,old_cap);
 }
 
+/* only ever increases capacities, entities are not moved */
+void mds_reserve(struct mds* m, mds_id cap[MDS_TYPES])
+{
+  int i;
+  int changed = 0;
+  mds_id old_cap[MDS_TYPES];
+  for (i = 0; i < MDS_TYPES; ++i) {
+    old_cap[i] = m->cap[i];
+    if (cap[i] > m->cap[i]) {
+      m->cap[i] = cap[i];
+      changed = 1;
+    }
+  }
+  if (changed)
+    resize(m,old_cap);
+}
+
 static mds_id fill_hole(struct mds* m, int t)
 {
   mds_id *head;
@@ -605,6 +624,7 @@ static void unrelate_ent(struct mds* m, mds_id e)
 void mds_destroy_entity(struct mds* m, mds_id e)
 {
   check_ent(m,e);
+  mds_unfreeze(m);
   if (TYPE(e) != MDS_VERTEX)
     unrelate_ent(m,e);
   free_ent(m,e);
@@ -620,6 +640,7 @@ void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down)
   mds_id od;
   check_ent(m, up);
   check_ent(m, down);
+  mds_unfreeze(m);
   ut = TYPE(up);
   ui = INDEX(up);
   dd = mds_dim[ut] - 1;
@@ -673,11 +694,41 @@ mds_id mds_create_entity(struct mds* m, int t, mds_id* from)
 {
   PCU_ALWAYS_ASSERT(0 <= t);
   PCU_ALWAYS_ASSERT(t < MDS_TYPES);
+  mds_unfreeze(m);
   if (t == MDS_VERTEX)
     return alloc_ent(m, t);
   return add_ent(m, t, from);
 }
 
+/* equivalent to n calls of mds_create_entity on a mesh
+   with no entities of type t yet, taking the downward
+   adjacencies of all of them at once */
+void mds_create_entities(struct mds* m, int t, mds_id n, mds_id* down)
+{
+  mds_id cap[MDS_TYPES];
+  mds_id i;
+  int dd;
+  int deg;
+  PCU_ALWAYS_ASSERT(0 <= t);
+  PCU_ALWAYS_ASSERT(t < MDS_TYPES);
+  PCU_ALWAYS_ASSERT(m->end[t] == 0);
+  mds_unfreeze(m);
+  for (i = 0; i < MDS_TYPES; ++i)
+    cap[i] = m->cap[i];
+  cap[t] = n;
+  mds_reserve(m, cap);
+  for (i = 0; i < n; ++i)
+    m->free[t][i] = MDS_LIVE;
+  m->n[t] = m->end[t] = n;
+  if (t == MDS_VERTEX || !n)
+    return;
+  dd = mds_dim[t] - 1;
+  deg = mds_degree[t][dd];
+  memcpy(m->down[dd][t], down, n * deg * sizeof(mds_id));
+  for (i = 0; i < n; ++i)
+    relate_back_up(m, m->down[dd][t] + i * deg, ID(t,i));
+}
+
 static void expand_once(struct mds* m, struct mds_set* from, struct mds_set* to)
 {
   int i;
@@ -723,6 +774,18 @@ static void get_down(struct mds* m, mds_id e, int d, struct mds_set* out)
   convert_down(m,&in,from_dim - 1,out,d,t);
 }
 
+static void look_frozen(struct mds* m, mds_id e, int d, struct mds_set* s)
+{
+  int j;
+  mds_id* o;
+  mds_id* u;
+  o = m->frozen_offsets[d][TYPE(e)] + INDEX(e);
+  u = m->frozen_up[d][TYPE(e)] + o[0];
+  s->n = o[1] - o[0];
+  for (j = 0; j < s->n; ++j)
+    s->e[j] = u[j];
+}
+
 void mds_get_adjacent(struct mds* m, mds_id e, int d, struct mds_set* s)
 {
   int e_dim;
@@ -732,6 +795,10 @@ void mds_get_adjacent(struct mds* m, mds_id e, int d, struct mds_set* s)
   }
   check_ent(m,e);
   e_dim = mds_dim[TYPE(e)];
+  if (m->frozen && d > e_dim) {
+    look_frozen(m,e,d,s);
+    return;
+  }
   if ((e_dim == d) || m->mrm[e_dim][d]) {
     look(m,e,d,s);
     return;
@@ -832,8 +899,91 @@ static void decrease_dimension(struct mds* m)
 
 void mds_change_dimension(struct mds* m, int d)
 {
+  mds_unfreeze(m);
   while (m->d < d)
     increase_dimension(m);
   while (m->d > d)
     decrease_dimension(m);
 }
+
+/* the frozen tables are a compressed sparse row copy of the
+   upward adjacencies: for entities of type t, the ones of
+   dimension d adjacent to index i are
+   frozen_up[d][t][frozen_offsets[d][t][i] ... frozen_offsets[d][t][i+1]),
+   listed in the same order that mds_get_adjacent would give them */
+
+/* entities with no upward adjacency (yet) are allowed here,
+   while get_up would reject them */
+static void look_unfrozen(struct mds* m, mds_id e, int d, struct mds_set* s)
+{
+  if (!mds_has_up(m, e))
+    s->n = 0;
+  else
+    mds_get_adjacent(m, e, d, s);
+}
+
+static void freeze_type(struct mds* m, int t, int d)
+{
+  mds_id i;
+  mds_id* o;
+  mds_id* u;
+  struct mds_set s;
+  o = NULL;
+  u = NULL;
+  REALLOC(o, m->end[t] + 1);
+  o[0] = 0;
+  for (i = 0; i < m->end[t]; ++i) {
+    o[i + 1] = o[i];
+    if (m->free[t][i] == MDS_LIVE) {
+      look_unfrozen(m, ID(t,i), d, &s);
+      o[i + 1] += s.n;
+    }
+  }
+  REALLOC(u, o[m->end[t]]);
+  for (i = 0; i < m->end[t]; ++i)
+    if (m->free[t][i] == MDS_LIVE) {
+      look_unfrozen(m, ID(t,i), d, &s);
+      if (s.n)
+        memcpy(u + o[i], s.e, s.n * sizeof(mds_id));
+    }
+  m->frozen_offsets[d][t] = o;
+  m->frozen_up[d][t] = u;
+}
+
+void mds_freeze(struct mds* m)
+{
+  int t;
+  int d;
+  mds_unfreeze(m);
+  for (t = 0; t < MDS_TYPES; ++t)
+    for (d = mds_dim[t] + 1; d <= m->d; ++d)
+      freeze_type(m, t, d);
+  m->frozen = 1;
+}
+
+void mds_unfreeze(struct mds* m)
+{
+  int t;
+  int d;
+  if (!m->frozen)
+    return;
+  for (d = 0; d < 4; ++d)
+    for (t = 0; t < MDS_TYPES; ++t) {
+      free(m->frozen_offsets[d][t]);
+      free(m->frozen_up[d][t]);
+      m->frozen_offsets[d][t] = NULL;
+      m->frozen_up[d][t] = NULL;
+    }
+  m->frozen = 0;
+}
+
+mds_id* mds_frozen_adjacent(struct mds* m, mds_id e, int d, int* n)
+{
+  mds_id* o;
+  if ((!m->frozen) || (d <= mds_dim[TYPE(e)]) || (d > m->d))
+    return NULL;
+  check_ent(m,e);
+  o = m->frozen_offsets[d][TYPE(e)] + INDEX(e);
+  *n = o[1] - o[0];
+  return m->frozen_up[d][TYPE(e)] + o[0];
+}
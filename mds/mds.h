@@ -41,6 +41,10 @@ struct mds {
   mds_id* first_up[4][MDS_TYPES];
   mds_id* free[MDS_TYPES];
   mds_id first_free[MDS_TYPES];
+  double growth;
+  int frozen;
+  mds_id* frozen_offsets[4][MDS_TYPES];
+  mds_id* frozen_up[4][MDS_TYPES];
 };
 
 struct mds_set {
@@ -54,7 +58,9 @@ extern int const* mds_types[MDS_TYPES][4];
 
 void mds_create(struct mds* m, int d, mds_id cap[MDS_TYPES]);
 void mds_destroy(struct mds* m);
+void mds_reserve(struct mds* m, mds_id cap[MDS_TYPES]);
 mds_id mds_create_entity(struct mds* m, int type, mds_id *from);
+void mds_create_entities(struct mds* m, int type, mds_id n, mds_id* down);
 void mds_destroy_entity(struct mds* m, mds_id e);
 int mds_type(mds_id e);
 mds_id mds_index(mds_id e);
@@ -72,4 +78,8 @@ void mds_change_dimension(struct mds* m, int d);
 
 void mds_hack_adjacent(struct mds* m, mds_id up, int i, mds_id down);
 
+void mds_freeze(struct mds* m);
+void mds_unfreeze(struct mds* m);
+mds_id* mds_frozen_adjacent(struct mds* m, mds_id e, int d, int* n);
+
 #endif
@@ -0,0 +1,235 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#include "mds_codec.h"
+#include <lionCompress.h>
+#include <pcu_io.h>
+#include <pcu_util.h>
+#include <reel.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/* bytes of (varint) payload per compressed block */
+size_t const blockBytes = 1 << 20;
+
+/* the encoding is these words followed by the
+   compressed end offset of each block, then the blocks */
+enum { PAYLOAD, BLOCK, BLOCKS, HEADER_WORDS };
+
+typedef std::vector<unsigned char> Bytes;
+
+/* runs f(i) for all blocks i in [0, n) on a few threads */
+template <class F>
+void forBlocks(size_t n, F const& f)
+{
+  size_t nt = std::thread::hardware_concurrency();
+  if (nt > n)
+    nt = n;
+  if (nt < 2) {
+    for (size_t i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < nt; ++t)
+    threads.push_back(std::thread([&]() {
+      for (size_t i = next++; i < n; i = next++)
+        f(i);
+    }));
+  for (size_t t = 0; t < nt; ++t)
+    threads[t].join();
+}
+
+uint64_t getWord(unsigned char const* p, int word)
+{
+  if (word == 4) {
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return x;
+  }
+  uint64_t x;
+  memcpy(&x, p, 8);
+  return x;
+}
+
+void setWord(unsigned char* p, int word, uint64_t x)
+{
+  if (word == 4) {
+    uint32_t y = static_cast<uint32_t>(x);
+    memcpy(p, &y, 4);
+  } else {
+    memcpy(p, &x, 8);
+  }
+}
+
+void deltaEncode(unsigned char const* data, size_t bytes, int word,
+    Bytes& out)
+{
+  PCU_ALWAYS_ASSERT(word == 4 || word == 8);
+  out.clear();
+  out.reserve(bytes / 2);
+  uint64_t prev = 0;
+  for (size_t i = 0; i < bytes; i += word) {
+    uint64_t x = getWord(data + i, word);
+    int64_t d = static_cast<int64_t>(x - prev);
+    uint64_t z = (static_cast<uint64_t>(d) << 1) ^
+      static_cast<uint64_t>(d >> 63);
+    while (z >= 0x80) {
+      out.push_back(static_cast<unsigned char>(z | 0x80));
+      z >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(z));
+    prev = x;
+  }
+}
+
+void deltaDecode(Bytes const& in, unsigned char* out, size_t bytes,
+    int word)
+{
+  size_t j = 0;
+  uint64_t prev = 0;
+  for (size_t i = 0; i < bytes; i += word) {
+    uint64_t z = 0;
+    int shift = 0;
+    do {
+      if (j == in.size() || shift > 63)
+        reel_fail("MDS: corrupt delta encoded section\n");
+      z |= static_cast<uint64_t>(in[j] & 0x7F) << shift;
+      shift += 7;
+    } while (in[j++] & 0x80);
+    uint64_t d = (z >> 1) ^ (~(z & 1) + 1);
+    prev += d;
+    setWord(out + i, word, prev);
+  }
+  if (j != in.size())
+    reel_fail("MDS: corrupt delta encoded section\n");
+}
+
+void swapWords(void* p, size_t bytes, int word)
+{
+  if (word == 4)
+    pcu_swap_unsigneds(static_cast<unsigned*>(p), bytes / 4);
+  else if (word == 8)
+    pcu_swap_doubles(static_cast<double*>(p), bytes / 8);
+}
+
+}
+
+int mds_can_compress(void)
+{
+  return lion::can_compress;
+}
+
+void* mds_encode(int codec, void const* data, size_t bytes, int word,
+    size_t* encoded)
+{
+  PCU_ALWAYS_ASSERT(codec == MDS_CODEC_ZLIB || codec == MDS_CODEC_DELTA);
+  if (!lion::can_compress)
+    reel_fail("MDS: compressed SMB files need -DLION_COMPRESS=ON\n");
+  unsigned char const* payload = static_cast<unsigned char const*>(data);
+  Bytes delta;
+  if (codec == MDS_CODEC_DELTA) {
+    deltaEncode(payload, bytes, word, delta);
+    bytes = delta.size();
+    payload = delta.empty() ? 0 : &delta[0];
+  }
+  size_t nblocks = (bytes + blockBytes - 1) / blockBytes;
+  std::vector<Bytes> blocks(nblocks);
+  forBlocks(nblocks, [&](size_t i) {
+    size_t first = i * blockBytes;
+    size_t n = std::min(blockBytes, bytes - first);
+    unsigned long len = lion::compressBound(n);
+    blocks[i].resize(len);
+    lion::compress(&blocks[i][0], len, payload + first, n);
+    blocks[i].resize(len);
+  });
+  size_t header = (HEADER_WORDS + nblocks) * sizeof(uint64_t);
+  std::vector<uint64_t> index(HEADER_WORDS + nblocks);
+  index[PAYLOAD] = bytes;
+  index[BLOCK] = blockBytes;
+  index[BLOCKS] = nblocks;
+  uint64_t end = 0;
+  for (size_t i = 0; i < nblocks; ++i) {
+    end += blocks[i].size();
+    index[HEADER_WORDS + i] = end;
+  }
+  *encoded = header + end;
+  unsigned char* out = static_cast<unsigned char*>(malloc(*encoded));
+  memcpy(out, &index[0], header);
+  for (size_t i = 0; i < nblocks; ++i)
+    if (!blocks[i].empty())
+      memcpy(out + header + index[HEADER_WORDS + i] - blocks[i].size(),
+          &blocks[i][0], blocks[i].size());
+  return out;
+}
+
+void mds_decode(int codec, void const* in, size_t encoded, int swapped,
+    void* out, size_t bytes, int word)
+{
+  PCU_ALWAYS_ASSERT(codec == MDS_CODEC_ZLIB || codec == MDS_CODEC_DELTA);
+  if (!lion::can_compress)
+    reel_fail("MDS: compressed SMB files need -DLION_COMPRESS=ON\n");
+  unsigned char const* p = static_cast<unsigned char const*>(in);
+  std::vector<uint64_t> index(HEADER_WORDS);
+  if (encoded < HEADER_WORDS * sizeof(uint64_t))
+    reel_fail("MDS: corrupt compressed section\n");
+  memcpy(&index[0], p, HEADER_WORDS * sizeof(uint64_t));
+  if (swapped)
+    swapWords(&index[0], HEADER_WORDS * sizeof(uint64_t), 8);
+  size_t nblocks = index[BLOCKS];
+  size_t block = index[BLOCK];
+  size_t header = (HEADER_WORDS + nblocks) * sizeof(uint64_t);
+  if (encoded < header || !block ||
+      nblocks != (index[PAYLOAD] + block - 1) / block)
+    reel_fail("MDS: corrupt compressed section\n");
+  index.resize(HEADER_WORDS + nblocks);
+  memcpy(&index[HEADER_WORDS], p + HEADER_WORDS * sizeof(uint64_t),
+      nblocks * sizeof(uint64_t));
+  if (swapped)
+    swapWords(&index[HEADER_WORDS], nblocks * sizeof(uint64_t), 8);
+  size_t payloadBytes = index[PAYLOAD];
+  Bytes delta;
+  unsigned char* payload = static_cast<unsigned char*>(out);
+  if (codec == MDS_CODEC_DELTA) {
+    delta.resize(payloadBytes);
+    payload = delta.empty() ? 0 : &delta[0];
+  } else if (payloadBytes != bytes) {
+    reel_fail("MDS: corrupt compressed section\n");
+  }
+  std::atomic<bool> ok(true);
+  forBlocks(nblocks, [&](size_t i) {
+    size_t begin = i ? index[HEADER_WORDS + i - 1] : 0;
+    size_t end = index[HEADER_WORDS + i];
+    if (begin > end || header + end > encoded) {
+      ok = false;
+      return;
+    }
+    size_t first = i * block;
+    size_t n = std::min(block, payloadBytes - first);
+    unsigned long len = n;
+    lion::uncompress(payload + first, len, p + header + begin, end - begin);
+    if (len != n)
+      ok = false;
+  });
+  if (!ok)
+    reel_fail("MDS: corrupt compressed section\n");
+  if (codec == MDS_CODEC_DELTA)
+    deltaDecode(delta, static_cast<unsigned char*>(out), bytes, word);
+  else if (swapped)
+    swapWords(out, bytes, word);
+}
@@ -75,6 +75,46 @@ void mds_apf_set_model(struct mds_apf* m, mds_id e, struct gmi_ent* model)
   m->model[mds_type(e)][mds_index(e)] = model;
 }
 
+/* resize everything that lives alongside the mds arrays
+   after the capacities have changed from old_cap */
+static void grow_apf(struct mds_apf* m, mds_id old_cap[MDS_TYPES])
+{
+  int t;
+  mds_grow_tags(&(m->tags),&(m->mds),old_cap);
+  if (m->mds.cap[MDS_VERTEX] != old_cap[MDS_VERTEX]) {
+    m->point = realloc(m->point,
+        m->mds.cap[MDS_VERTEX] * sizeof(*(m->point)));
+    m->param = realloc(m->param,
+        m->mds.cap[MDS_VERTEX] * sizeof(*(m->param)));
+  }
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (m->mds.cap[t] == old_cap[t])
+      continue;
+    m->model[t] = realloc(m->model[t],
+        m->mds.cap[t] * sizeof(*(m->model[t])));
+    m->parts[t] = realloc(m->parts[t],
+        m->mds.cap[t] * sizeof(*(m->parts[t])));
+  }
+  mds_grow_net(&m->remotes, &m->mds, old_cap);
+  mds_grow_net(&m->ghosts, &m->mds, old_cap); //seol
+  mds_grow_net(&m->matches, &m->mds, old_cap);
+}
+
+void mds_apf_reserve(struct mds_apf* m, mds_id cap[MDS_TYPES])
+{
+  int t;
+  int changed = 0;
+  mds_id old_cap[MDS_TYPES];
+  for (t = 0; t < MDS_TYPES; ++t)
+    old_cap[t] = m->mds.cap[t];
+  mds_reserve(&(m->mds),cap);
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (m->mds.cap[t] != old_cap[t])
+      changed = 1;
+  if (changed)
+    grow_apf(m,old_cap);
+}
+
 mds_id mds_apf_create_entity(
     struct mds_apf* m, int type, struct gmi_ent* model, mds_id* from)
 {
@@ -82,26 +122,12 @@ mds_id mds_apf_create_entity(
   mds_id old_cap[MDS_TYPES];
   mds_id e;
   mds_id i;
-  old_cap[type] = m->mds.cap[type];
+  for (t = 0; t < MDS_TYPES; ++t)
+    old_cap[t] = m->mds.cap[t];
   e = mds_create_entity(&(m->mds),type,from);
   i = mds_index(e);
-  if (m->mds.cap[type] != old_cap[type]) {
-    for (t = 0; t < MDS_TYPES; ++t)
-      if (t != type)
-        old_cap[t] = m->mds.cap[t];
-    mds_grow_tags(&(m->tags),&(m->mds),old_cap);
-    if (type == MDS_VERTEX) {
-      m->point = realloc(m->point,m->mds.cap[type] * sizeof(*(m->point)));
-      m->param = realloc(m->param,m->mds.cap[type] * sizeof(*(m->param)));
-    }
-    m->model[type] = realloc(m->model[type],
-        m->mds.cap[type] * sizeof(*(m->model[type])));
-    m->parts[type] = realloc(m->parts[type],
-        m->mds.cap[type] * sizeof(*(m->parts[type])));
-    mds_grow_net(&m->remotes, &m->mds, old_cap); 
-    mds_grow_net(&m->ghosts, &m->mds, old_cap); //seol
-    mds_grow_net(&m->matches, &m->mds, old_cap);
-  }
+  if (m->mds.cap[type] != old_cap[type])
+    grow_apf(m,old_cap);
   m->model[type][i] = model;
   m->parts[type][i] = NULL;
   if (type == MDS_VERTEX) {
@@ -304,6 +330,13 @@ int mds_align_remotes(PCU_t h, struct mds_apf* m)
   return align_copies(h, &m->remotes, &m->mds);
 }
 
+void mds_compact_copies(struct mds_apf* m)
+{
+  mds_compact_net(&m->remotes, &m->mds);
+  mds_compact_net(&m->ghosts, &m->mds);
+  mds_compact_net(&m->matches, &m->mds);
+}
+
 void mds_update_model_for_entity(struct mds_apf* m, mds_id e,
 				   int dim, int modelTag)
 {
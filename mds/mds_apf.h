@@ -45,6 +45,7 @@ struct mds_apf {
 struct mds_apf* mds_apf_create(struct gmi_model* model, int d,
     mds_id cap[MDS_TYPES]);
 void mds_apf_destroy(struct mds_apf* m);
+void mds_apf_reserve(struct mds_apf* m, mds_id cap[MDS_TYPES]);
 double* mds_apf_point(struct mds_apf* m, mds_id e);
 double* mds_apf_param(struct mds_apf* m, mds_id e);
 struct gmi_ent* mds_apf_model(struct mds_apf* m, mds_id e);
@@ -57,6 +58,22 @@ void* mds_get_part(struct mds_apf* m, mds_id e);
 void mds_set_part(struct mds_apf* m, mds_id e, void* p);
 
 struct mds_tag* mds_number_verts_bfs(struct mds_apf* m);
+
+enum {
+  MDS_HILBERT,
+  MDS_MORTON
+};
+
+struct mds_tag* mds_number_sfc(struct mds_apf* m, int curve);
+
+struct mds_order_quality {
+  mds_id bandwidth;
+  double mean_bandwidth;
+  double misses;
+  mds_id elements;
+};
+
+void mds_measure_order(struct mds_apf* m, struct mds_order_quality* q);
 struct mds_apf* mds_reorder(PCU_t h, struct mds_apf* m, int ignore_peers,
     struct mds_tag* vert_numbers);
 
@@ -75,6 +92,7 @@ void mds_verify_residence(struct mds_apf* m, mds_id e);
 int mds_align_matches(PCU_t h, struct mds_apf* m);
 int mds_align_ghosts(PCU_t h, struct mds_apf* m);
 int mds_align_remotes(PCU_t h, struct mds_apf* m);
+void mds_compact_copies(struct mds_apf* m);
 
 void mds_derive_model(struct mds_apf* m);
   void mds_update_model_for_entity(struct mds_apf* m, mds_id e,
@@ -0,0 +1,46 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+
+#ifndef MDS_CODEC_H
+#define MDS_CODEC_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* encodings of SMB file sections.
+   compressed sections are split into independent zlib blocks
+   listed in an index, so both directions run on several threads.
+   the delta codec first replaces each word by its zigzag varint
+   difference from the previous one, which shrinks the slowly
+   varying entity indices of connectivity and remote copies. */
+enum {
+  MDS_CODEC_RAW,
+  MDS_CODEC_ZLIB,
+  MDS_CODEC_DELTA
+};
+
+int mds_can_compress(void);
+/* returns a malloc'ed encoding of (bytes) bytes of words
+   of (word) bytes each, whose size is put in (encoded) */
+void* mds_encode(int codec, void const* data, size_t bytes, int word,
+    size_t* encoded);
+/* decodes into (out), which holds (bytes) bytes.
+   (swapped) says the writer had the other byte order */
+void mds_decode(int codec, void const* in, size_t encoded, int swapped,
+    void* out, size_t bytes, int word);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
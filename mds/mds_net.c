@@ -24,6 +24,8 @@ void mds_destroy_net(struct mds_net* net, struct mds* m)
   int t;
   mds_id i;
   for (t = 0; t < MDS_TYPES; ++t) {
+    free(net->offsets[t]);
+    free(net->pool[t]);
     if (net->data[t])
       for (i = 0; i < m->cap[t]; ++i)
         free(net->data[t][i]);
@@ -45,6 +47,9 @@ void mds_set_copies(struct mds_net* net, struct mds* m, mds_id e,
   struct mds_copies** p;
   int t;
   mds_id i;
+  if (!c && !mds_get_copies(net, e))
+    return;
+  mds_expand_net(net, m);
   t = mds_type(e);
   i = mds_index(e);
   if (!net->data[t]) {
@@ -67,9 +72,23 @@ void mds_set_copies(struct mds_net* net, struct mds* m, mds_id e,
   }
 }
 
+static struct mds_copies* get_compact(struct mds_net* net, mds_id e)
+{
+  int t = mds_type(e);
+  mds_id o;
+  if (!net->offsets[t])
+    return NULL;
+  o = net->offsets[t][mds_index(e)];
+  if (o < 0)
+    return NULL;
+  return (struct mds_copies*)(net->pool[t] + o);
+}
+
 struct mds_copies* mds_get_copies(struct mds_net* net, mds_id e)
 {
   int t = mds_type(e);
+  if (net->compact)
+    return get_compact(net, e);
   if (!net->data[t])
     return NULL;
   return net->data[t][mds_index(e)];
@@ -82,6 +101,7 @@ void mds_grow_net(
 {
   int t;
   mds_id i;
+  mds_expand_net(net, m);
   for (t = 0; t < MDS_TYPES; ++t)
     if (net->data[t]) {
       net->data[t] = realloc(net->data[t],
@@ -107,6 +127,7 @@ void mds_add_copy(struct mds_net* net, struct mds* m, mds_id e,
   int t;
   int p;
   mds_id i;
+  mds_expand_net(net, m);
   t = mds_type(e);
   i = mds_index(e);
   cs = mds_get_copies(net, e);
@@ -284,11 +305,89 @@ int mds_net_empty(struct mds_net* net)
 {
   int t;
   for (t = 0; t < MDS_TYPES; ++t)
-    if (net->data[t])
+    if (net->n[t])
       return 0;
   return 1;
 }
 
+/* the size of a packed copies record, keeping the next one aligned */
+static size_t record_size(int n)
+{
+  size_t a;
+  size_t s;
+  a = sizeof(struct mds_copy);
+  s = sizeof(struct mds_copies) + (n - 1) * sizeof(struct mds_copy);
+  return ((s + a - 1) / a) * a;
+}
+
+/* packs the copies into one pool per type, dropping the
+   per-entity blocks. the modifying functions expand
+   the net again as needed. */
+void mds_compact_net(struct mds_net* net, struct mds* m)
+{
+  int t;
+  mds_id i;
+  size_t bytes;
+  struct mds_copies* cs;
+  if (net->compact)
+    return;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (!net->data[t])
+      continue;
+    bytes = 0;
+    for (i = 0; i < m->cap[t]; ++i)
+      if (net->data[t][i])
+        bytes += record_size(net->data[t][i]->n);
+    net->pool[t] = malloc(bytes);
+    net->offsets[t] = malloc(m->cap[t] * sizeof(mds_id));
+    net->cap[t] = m->cap[t];
+    bytes = 0;
+    for (i = 0; i < m->cap[t]; ++i) {
+      cs = net->data[t][i];
+      if (!cs) {
+        net->offsets[t][i] = -1;
+        continue;
+      }
+      net->offsets[t][i] = bytes;
+      memcpy(net->pool[t] + bytes, cs, sizeof(struct mds_copies) +
+          (cs->n - 1) * sizeof(struct mds_copy));
+      bytes += record_size(cs->n);
+      free(cs);
+    }
+    free(net->data[t]);
+    net->data[t] = NULL;
+  }
+  net->compact = 1;
+}
+
+void mds_expand_net(struct mds_net* net, struct mds* m)
+{
+  int t;
+  mds_id i;
+  struct mds_copies* cs;
+  struct mds_copies* c;
+  if (!net->compact)
+    return;
+  for (t = 0; t < MDS_TYPES; ++t) {
+    if (!net->offsets[t])
+      continue;
+    net->data[t] = calloc(net->cap[t], sizeof(*(net->data[t])));
+    for (i = 0; i < net->cap[t]; ++i) {
+      cs = get_compact(net, mds_identify(t, i));
+      if (!cs)
+        continue;
+      c = mds_make_copies(cs->n);
+      memcpy(c->c, cs->c, cs->n * sizeof(struct mds_copy));
+      net->data[t][i] = c;
+    }
+    free(net->offsets[t]);
+    free(net->pool[t]);
+    net->offsets[t] = NULL;
+    net->pool[t] = NULL;
+  }
+  net->compact = 0;
+}
+
 static void note_local_link(PCU_t h, mds_id i, struct mds_copy c, void* u)
 {
   if (c.p == PCU_Comm_Self(h)) {
@@ -25,9 +25,18 @@ struct mds_copies {
   struct mds_copy c[1];
 };
 
+/* while the net is compact, the copies of all entities of type t
+   are packed back to back into pool[t], with the entity of index i
+   at byte offset offsets[t][i] (or -1 if it has no copies),
+   and the per-entity data[t] blocks are released.
+   offsets[t] has cap[t] entries, the capacity at compaction. */
 struct mds_net {
   mds_id n[MDS_TYPES];
   struct mds_copies** data[MDS_TYPES];
+  int compact;
+  mds_id cap[MDS_TYPES];
+  mds_id* offsets[MDS_TYPES];
+  char* pool[MDS_TYPES];
 };
 
 struct mds_links {
@@ -60,6 +69,9 @@ void mds_free_links(struct mds_links* ln);
 
 int mds_net_empty(struct mds_net* net);
 
+void mds_compact_net(struct mds_net* net, struct mds* m);
+void mds_expand_net(struct mds_net* net, struct mds* m);
+
 void mds_get_local_matches(PCU_t h, struct mds_net* net, struct mds* m,
                          int t, struct mds_links* ln);
 void mds_set_local_matches(PCU_t h, struct mds_net* net, struct mds* m,
@@ -14,6 +14,7 @@
 #include <string.h>
 #include <limits.h>
 #include <PCU_C.h>
+#include <stdint.h>
 
 struct queue {
   mds_id* e;
@@ -134,6 +135,219 @@ struct mds_tag* mds_number_verts_bfs(struct mds_apf* m)
   return tag;
 }
 
+/* bits per axis of the space filling curve keys */
+#define SFC_BITS 21
+
+struct sfc_item {
+  uint64_t key;
+  mds_id e;
+};
+
+static int compare_sfc(const void* a, const void* b)
+{
+  struct sfc_item const* x = a;
+  struct sfc_item const* y = b;
+  if (x->key != y->key)
+    return x->key < y->key ? -1 : 1;
+  return x->e < y->e ? -1 : (x->e > y->e);
+}
+
+static uint64_t interleave(uint32_t x[3])
+{
+  uint64_t key = 0;
+  int b, i;
+  for (b = SFC_BITS - 1; b >= 0; --b)
+    for (i = 0; i < 3; ++i)
+      key = (key << 1) | ((x[i] >> b) & 1);
+  return key;
+}
+
+/* J. Skilling, "Programming the Hilbert curve",
+   AIP Conference Proceedings 707, 2004.
+   turns the axes into the transposed Hilbert index,
+   whose interleaved bits are the index itself */
+static uint64_t hilbert_key(uint32_t x[3])
+{
+  uint32_t const top = 1u << (SFC_BITS - 1);
+  uint32_t p, q, t;
+  int i;
+  for (q = top; q > 1; q >>= 1) {
+    p = q - 1;
+    for (i = 0; i < 3; ++i)
+      if (x[i] & q) {
+        x[0] ^= p;
+      } else {
+        t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+  }
+  for (i = 1; i < 3; ++i)
+    x[i] ^= x[i - 1];
+  t = 0;
+  for (q = top; q > 1; q >>= 1)
+    if (x[2] & q)
+      t ^= q - 1;
+  for (i = 0; i < 3; ++i)
+    x[i] ^= t;
+  return interleave(x);
+}
+
+struct sfc_box {
+  double min[3];
+  double scale[3];
+};
+
+static void make_box(struct mds_apf* m, struct sfc_box* b)
+{
+  double max[3];
+  double* p;
+  mds_id v;
+  int i;
+  for (i = 0; i < 3; ++i) {
+    b->min[i] = 0;
+    max[i] = 0;
+  }
+  v = mds_begin(&m->mds, 0);
+  if (v != MDS_NONE)
+    for (i = 0; i < 3; ++i)
+      b->min[i] = max[i] = mds_apf_point(m, v)[i];
+  for (; v != MDS_NONE; v = mds_next(&m->mds, v)) {
+    p = mds_apf_point(m, v);
+    for (i = 0; i < 3; ++i) {
+      if (p[i] < b->min[i])
+        b->min[i] = p[i];
+      if (p[i] > max[i])
+        max[i] = p[i];
+    }
+  }
+  for (i = 0; i < 3; ++i)
+    if (max[i] > b->min[i])
+      b->scale[i] = ((1u << SFC_BITS) - 1) / (max[i] - b->min[i]);
+    else
+      b->scale[i] = 0;
+}
+
+static uint64_t sfc_key(struct sfc_box* b, double const p[3], int curve)
+{
+  uint32_t x[3];
+  int i;
+  for (i = 0; i < 3; ++i)
+    x[i] = (uint32_t)((p[i] - b->min[i]) * b->scale[i]);
+  if (curve == MDS_HILBERT)
+    return hilbert_key(x);
+  return interleave(x);
+}
+
+static void centroid(struct mds_apf* m, mds_id e, double c[3])
+{
+  struct mds_set vs;
+  double* p;
+  int i, j;
+  c[0] = c[1] = c[2] = 0;
+  if (mds_type(e) == MDS_VERTEX) {
+    p = mds_apf_point(m, e);
+    for (j = 0; j < 3; ++j)
+      c[j] = p[j];
+    return;
+  }
+  mds_get_adjacent(&m->mds, e, 0, &vs);
+  for (i = 0; i < vs.n; ++i) {
+    p = mds_apf_point(m, vs.e[i]);
+    for (j = 0; j < 3; ++j)
+      c[j] += p[j];
+  }
+  for (j = 0; j < 3; ++j)
+    c[j] /= vs.n;
+}
+
+static void number_type_sfc(struct mds_apf* m, struct sfc_box* b,
+    int curve, struct mds_tag* tag, int type)
+{
+  struct sfc_item* items;
+  mds_id n = 0;
+  mds_id i;
+  double c[3];
+  int label = 0;
+  items = malloc(m->mds.n[type] * sizeof(*items));
+  for (i = 0; i < m->mds.end[type]; ++i) {
+    if (m->mds.free[type][i] != MDS_LIVE)
+      continue;
+    items[n].e = mds_identify(type, i);
+    centroid(m, items[n].e, c);
+    items[n].key = sfc_key(b, c, curve);
+    ++n;
+  }
+  PCU_ALWAYS_ASSERT(n == m->mds.n[type]);
+  qsort(items, n, sizeof(*items), compare_sfc);
+  for (i = 0; i < n; ++i)
+    visit(&m->mds, tag, &label, items[i].e);
+  free(items);
+}
+
+/* numbers vertices and elements in the order of a space filling
+   curve through their centroids, leaving the other entities
+   to mds_reorder. */
+struct mds_tag* mds_number_sfc(struct mds_apf* m, int curve)
+{
+  struct mds_tag* tag;
+  struct sfc_box b;
+  int t;
+  PCU_ALWAYS_ASSERT(m->mds.n[MDS_VERTEX] < INT_MAX);
+  tag = mds_create_tag(&m->tags, "mds_number", sizeof(int), 1);
+  make_box(m, &b);
+  for (t = 0; t < MDS_TYPES; ++t)
+    if (t == MDS_VERTEX || mds_dim[t] == m->mds.d)
+      number_type_sfc(m, &b, curve, tag, t);
+  return tag;
+}
+
+/* element locality is measured by replaying element traversal
+   against a cache holding the vertices of the last few elements */
+#define ORDER_WINDOW 64
+
+void mds_measure_order(struct mds_apf* m, struct mds_order_quality* q)
+{
+  struct mds_set vs;
+  mds_id e;
+  mds_id d;
+  mds_id* last;
+  mds_id k;
+  double sum = 0;
+  mds_id edges = 0;
+  double misses = 0;
+  int i;
+  q->bandwidth = 0;
+  for (e = mds_begin(&m->mds, 1); e != MDS_NONE; e = mds_next(&m->mds, e)) {
+    mds_get_adjacent(&m->mds, e, 0, &vs);
+    d = mds_index(vs.e[1]) - mds_index(vs.e[0]);
+    if (d < 0)
+      d = -d;
+    if (d > q->bandwidth)
+      q->bandwidth = d;
+    sum += d;
+    ++edges;
+  }
+  q->mean_bandwidth = edges ? sum / edges : 0;
+  last = malloc(m->mds.end[MDS_VERTEX] * sizeof(*last));
+  for (k = 0; k < m->mds.end[MDS_VERTEX]; ++k)
+    last[k] = -ORDER_WINDOW - 1;
+  k = 0;
+  for (e = mds_begin(&m->mds, m->mds.d); e != MDS_NONE;
+       e = mds_next(&m->mds, e)) {
+    mds_get_adjacent(&m->mds, e, 0, &vs);
+    for (i = 0; i < vs.n; ++i) {
+      if (k - last[mds_index(vs.e[i])] > ORDER_WINDOW)
+        ++misses;
+      last[mds_index(vs.e[i])] = k;
+    }
+    ++k;
+  }
+  free(last);
+  q->elements = k;
+  q->misses = k ? misses / k : 0;
+}
+
 static mds_id* sort_verts(struct mds_apf* m, struct mds_tag* tag)
 {
   mds_id v;
@@ -165,13 +379,24 @@ static void number_ents_of_type(struct mds* m,
   }
 }
 
+/* types that mds_number_sfc already numbered */
+static int is_numbered(struct mds* m, struct mds_tag* tag, int type)
+{
+  mds_id i;
+  for (i = 0; i < m->end[type]; ++i)
+    if (m->free[type][i] == MDS_LIVE)
+      return mds_has_tag(tag, mds_identify(type, i));
+  return 0;
+}
+
 static void number_other_ents(struct mds_apf* m, struct mds_tag* tag)
 {
   mds_id* sorted_verts;
   int type;
   sorted_verts = sort_verts(m, tag);
   for (type = MDS_VERTEX + 1; type < MDS_TYPES; ++type)
-    number_ents_of_type(&m->mds, sorted_verts, tag, type);
+    if (!is_numbered(&m->mds, tag, type))
+      number_ents_of_type(&m->mds, sorted_verts, tag, type);
   free(sorted_verts);
 }
 
@@ -388,6 +613,7 @@ static struct mds_apf* rebuild(
   struct mds_apf* m2;
   struct mds_tag* old_of;
   m2 = mds_apf_create(m->user_model, m->mds.d, m->mds.n);
+  m2->mds.growth = m->mds.growth;
   old_of = invert(&m->mds, m2, new_of);
   rebuild_verts(m, m2, old_of);
   rebuild_ents(m, m2, old_of, new_of);
@@ -414,6 +640,7 @@ struct mds_apf* mds_reorder(PCU_t h, struct mds_apf* m, int ignore_peers,
   tag = vert_numbers;
   number_other_ents(m, tag);
   m2 = rebuild(h, m, tag, ignore_peers);
+  mds_compact_copies(m2);
   mds_apf_destroy(m);
   return m2;
 }
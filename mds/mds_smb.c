@@ -21,8 +21,14 @@
 #include <sys/types.h> /*required for mode_t for mkdir on some systems*/
 #include <sys/stat.h> /*using POSIX mkdir call for SMB "foo/" path*/
 #include <errno.h> /* for checking the error from mkdir */
+#include <stdint.h>
+#include "mds_codec.h"
 
-enum { SMB_VERSION = 6 };
+enum { SMB_VERSION = 7 };
+
+/* the last version whose body is a single stream,
+   still written for compressed files */
+enum { SMB_STREAM_VERSION = 6 };
 
 enum {
   SMB_VERT,
@@ -41,6 +47,51 @@ enum {
   SMB_DBL
 };
 
+/* starting with version 7, the header is followed by a table
+   of contents and the bulk arrays are stored as aligned sections
+   in the byte order of the writer, so that a reader on a similar
+   machine can map the file and use them without decoding.
+   everything else is in one trailing stream section,
+   in the same encoding as the older versions.
+   each section may instead be block compressed (see mds_codec.h),
+   which is what the "zip:" path prefix asks for. */
+enum {
+  SMB_SEC_COORDS,
+  SMB_SEC_PARAMS,
+  SMB_SEC_CLASS,
+  SMB_SEC_REMOTES,
+  SMB_SEC_CONN,
+  SMB_SEC_STREAM = SMB_SEC_CONN + SMB_TYPES,
+  SMB_SECTIONS
+};
+
+/* whole file compression given by the path prefix */
+enum {
+  SMB_PLAIN,
+  SMB_BZ2,
+  SMB_ZLIB
+};
+
+#define SMB_ALIGN 64
+#define SMB_BYTE_ORDER 0x01020304u
+#define SMB_HEADER_BYTES (4 * sizeof(unsigned))
+
+struct smb_section {
+  uint64_t offset;
+  uint64_t bytes;
+  uint64_t stored;
+  uint64_t codec;
+};
+
+struct smb_toc {
+  uint32_t byte_order;
+  uint32_t id_bytes;
+  uint32_t n[SMB_TYPES];
+  uint32_t nsections;
+  uint32_t pad;
+  struct smb_section sections[SMB_SECTIONS];
+};
+
 /* these limits are just for sanity checking
    of the input file contents.
    they do not reflect hard limitations anywhere
@@ -133,11 +184,10 @@ static void read_header(PCU_t h, struct pcu_file* f, unsigned* version, unsigned
         "the # of mesh partitions != the # of MPI ranks");
 }
 
-static void write_header(PCU_t h, struct pcu_file* f, unsigned dim,
-    int ignore_peers)
+static void write_header(PCU_t h, struct pcu_file* f, unsigned version,
+    unsigned dim, int ignore_peers)
 {
   unsigned magic = 0;
-  unsigned version = SMB_VERSION;
   unsigned np;
   PCU_WRITE_UNSIGNED(f, magic);
   PCU_WRITE_UNSIGNED(f, version);
@@ -559,8 +609,194 @@ static void write_matches(PCU_t h, struct pcu_file* f, struct mds_apf* m,
     write_type_matches(h, f, m, smb2mds(t), ignore_peers);
 }
 
+static void swap_toc(struct smb_toc* toc)
+{
+  pcu_swap_unsigneds((unsigned*)toc, 4 + SMB_TYPES);
+  pcu_swap_doubles((double*)toc->sections, 4 * SMB_SECTIONS);
+}
+
+struct smb_map {
+  char* data;
+  size_t size;
+  struct smb_toc* toc;
+  int swapped;
+  void* decoded[SMB_SECTIONS];
+};
+
+/* returns the contents of a section made of words of the given
+   size, which are used in place from the mapping when they are
+   not compressed. the mapping is private, so byte swapping
+   here does not touch the file. */
+static void* get_section(struct smb_map* map, int s, int word)
+{
+  struct smb_section* sec = &map->toc->sections[s];
+  char* p;
+  if (sec->offset + sec->stored > map->size || sec->offset % SMB_ALIGN ||
+      sec->codec > MDS_CODEC_DELTA)
+    reel_fail("MDS: bad smb section %d\n", s);
+  p = map->data + sec->offset;
+  if (sec->codec != MDS_CODEC_RAW) {
+    map->decoded[s] = malloc(sec->bytes);
+    mds_decode(sec->codec, p, sec->stored, map->swapped,
+        map->decoded[s], sec->bytes, word);
+    return map->decoded[s];
+  }
+  if (sec->stored != sec->bytes)
+    reel_fail("MDS: bad smb section %d\n", s);
+  if (map->swapped && word == 4)
+    pcu_swap_unsigneds((unsigned*)p, sec->bytes / 4);
+  if (map->swapped && word == 8)
+    pcu_swap_doubles((double*)p, sec->bytes / 8);
+  return p;
+}
+
+static void map_conn(struct smb_map* map, struct mds_apf* m)
+{
+  struct smb_toc* toc = map->toc;
+  int i;
+  int type_mds;
+  size_t count;
+  size_t j;
+  mds_id* conn;
+  uint32_t* conn32;
+  uint64_t* conn64;
+  for (i = 1; i < SMB_TYPES; ++i) {
+    type_mds = smb2mds(i);
+    count = (size_t)toc->n[i] * down_degree(type_mds);
+    PCU_ALWAYS_ASSERT(toc->sections[SMB_SEC_CONN + i].bytes ==
+        count * toc->id_bytes);
+    conn = get_section(map, SMB_SEC_CONN + i, toc->id_bytes);
+    if (toc->id_bytes == sizeof(mds_id)) {
+      mds_create_entities(&m->mds, type_mds, toc->n[i], conn);
+      continue;
+    }
+    /* written with a different MDS_ID_TYPE, convert */
+    conn32 = (uint32_t*)conn;
+    conn64 = (uint64_t*)conn;
+    conn = malloc(count * sizeof(*conn));
+    for (j = 0; j < count; ++j)
+      conn[j] = (toc->id_bytes == 4) ? (mds_id)conn32[j] : (mds_id)conn64[j];
+    mds_create_entities(&m->mds, type_mds, toc->n[i], conn);
+    free(conn);
+  }
+}
+
+static void map_class(struct smb_map* map, struct mds_apf* m)
+{
+  uint32_t* class;
+  int i;
+  int type_mds;
+  mds_id j;
+  class = get_section(map, SMB_SEC_CLASS, 4);
+  for (i = 0; i < SMB_TYPES; ++i) {
+    type_mds = smb2mds(i);
+    for (j = 0; j < m->mds.end[type_mds]; ++j) {
+      m->model[type_mds][j] = mds_find_model(m, class[1], class[0]);
+      PCU_ALWAYS_ASSERT(m->model[type_mds][j]);
+      class += 2;
+    }
+  }
+}
+
+static void map_points(struct smb_map* map, int s, void* to, size_t bytes)
+{
+  PCU_ALWAYS_ASSERT(map->toc->sections[s].bytes == bytes);
+  if (bytes)
+    memcpy(to, get_section(map, s, 8), bytes);
+}
+
+/* the remotes section holds the links of read_links as
+   (np, p[np], n[np], l[0][n[0]], l[1][n[1]], ...) */
+static void map_remotes(PCU_t h, struct smb_map* map, struct mds_apf* m,
+    int ignore_peers)
+{
+  struct mds_links ln = MDS_LINKS_INIT;
+  unsigned* w;
+  size_t nw;
+  size_t k;
+  unsigned i;
+  w = get_section(map, SMB_SEC_REMOTES, 4);
+  nw = map->toc->sections[SMB_SEC_REMOTES].bytes / sizeof(unsigned);
+  PCU_ALWAYS_ASSERT(nw >= 1);
+  ln.np = w[0];
+  PCU_ALWAYS_ASSERT(ln.np < MAX_PEERS);
+  k = 1 + 2 * (size_t)ln.np;
+  PCU_ALWAYS_ASSERT(k <= nw);
+  if (ln.np) {
+    ln.p = malloc(ln.np * sizeof(unsigned));
+    memcpy(ln.p, w + 1, ln.np * sizeof(unsigned));
+    ln.n = malloc(ln.np * sizeof(unsigned));
+    memcpy(ln.n, w + 1 + ln.np, ln.np * sizeof(unsigned));
+    ln.l = malloc(ln.np * sizeof(unsigned*));
+    for (i = 0; i < ln.np; ++i) {
+      PCU_ALWAYS_ASSERT(k + ln.n[i] <= nw);
+      ln.l[i] = malloc(ln.n[i] * sizeof(unsigned));
+      memcpy(ln.l[i], w + k, ln.n[i] * sizeof(unsigned));
+      k += ln.n[i];
+    }
+  }
+  if (!ignore_peers)
+    mds_set_type_links(h, &m->remotes, &m->mds, MDS_VERTEX, &ln);
+  mds_free_links(&ln);
+}
+
+static struct mds_apf* map_smb(PCU_t h, struct gmi_model* model,
+    struct pcu_file* f, unsigned dim, int ignore_peers, void* apf_mesh)
+{
+  struct mds_apf* m;
+  struct smb_map map;
+  struct smb_toc* toc;
+  struct pcu_file* stream;
+  mds_id cap[MDS_TYPES];
+  size_t nv;
+  int i;
+  memset(&map, 0, sizeof(map));
+  map.data = pcu_fmap(f, &map.size);
+  if (map.size < SMB_HEADER_BYTES + sizeof(*toc))
+    reel_fail("MDS: smb file is too small\n");
+  toc = map.toc = (struct smb_toc*)(map.data + SMB_HEADER_BYTES);
+  map.swapped = (toc->byte_order != SMB_BYTE_ORDER);
+  if (map.swapped)
+    swap_toc(toc);
+  if (toc->byte_order != SMB_BYTE_ORDER || toc->nsections != SMB_SECTIONS)
+    reel_fail("MDS: bad smb table of contents\n");
+  PCU_ALWAYS_ASSERT(toc->id_bytes == 4 || toc->id_bytes == 8);
+  for (i = 0; i < MDS_TYPES; ++i) {
+    cap[i] = toc->n[mds2smb(i)];
+    if (sizeof(mds_id) == 4) PCU_ALWAYS_ASSERT(cap[i] < MAX_ENTITIES);
+  }
+  m = mds_apf_create(model, dim, cap);
+  nv = toc->n[SMB_VERT];
+  mds_create_entities(&m->mds, MDS_VERTEX, nv, NULL);
+  map_conn(&map, m);
+  map_points(&map, SMB_SEC_COORDS, m->point, nv * sizeof(m->point[0]));
+  map_points(&map, SMB_SEC_PARAMS, m->param, nv * sizeof(m->param[0]));
+  map_class(&map, m);
+  map_remotes(h, &map, m, ignore_peers);
+  stream = pcu_fmemopen_read(get_section(&map, SMB_SEC_STREAM, 1),
+      toc->sections[SMB_SEC_STREAM].bytes);
+  read_tags(stream, m);
+  read_matches_new(h, stream, m, ignore_peers);
+  mds_read_smb_meta(stream, m, apf_mesh);
+  pcu_fclose(stream);
+  for (i = 0; i < SMB_SECTIONS; ++i)
+    free(map.decoded[i]);
+  pcu_funmap(f, map.data, map.size);
+  return m;
+}
+
+/* file is the index of the shared file of this rank,
+   or -1 for a file of its own */
+static struct pcu_file* open_smb(PCU_t h, const char* filename, int file,
+    int write, int zip)
+{
+  if (file >= 0)
+    return pcu_fopen_shared(h, filename, file, write, zip == SMB_BZ2);
+  return pcu_fopen(h, filename, write, zip == SMB_BZ2);
+}
+
 static struct mds_apf* read_smb(PCU_t h, struct gmi_model* model, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+    int file, int zip, int ignore_peers, void* apf_mesh)
 {
   struct mds_apf* m;
   struct pcu_file* f;
@@ -571,9 +807,16 @@ static struct mds_apf* read_smb(PCU_t h, struct gmi_model* model, const char* fi
   int i;
   unsigned tmp;
   unsigned pi, pj;
-  f = pcu_fopen(h, filename, 0, zip);
+  f = open_smb(h, filename, file, 0, zip);
   PCU_ALWAYS_ASSERT(f);
   read_header(h, f, &version, &dim, ignore_peers);
+  if (version > SMB_STREAM_VERSION) {
+    if (zip == SMB_BZ2)
+      reel_fail("MDS: smb version %u can't be bzip2 compressed\n", version);
+    m = map_smb(h, model, f, dim, ignore_peers, apf_mesh);
+    pcu_fclose(f);
+    return m;
+  }
   pcu_read_unsigneds(f, n, SMB_TYPES);
   for (i = 0; i < MDS_TYPES; ++i) {
     tmp = n[mds2smb(i)];
@@ -614,15 +857,186 @@ static void write_coords(struct pcu_file* f, struct mds_apf* m)
   pcu_write_doubles(f, &m->param[0][0], count);
 }
 
+static uint64_t align_section(uint64_t offset)
+{
+  return ((offset + SMB_ALIGN - 1) / SMB_ALIGN) * SMB_ALIGN;
+}
+
+static void write_section(struct pcu_file* f, uint64_t* at,
+    struct smb_section* sec, void const* data)
+{
+  static char const zeros[SMB_ALIGN] = {0};
+  PCU_ALWAYS_ASSERT(sec->offset - *at < SMB_ALIGN);
+  pcu_write(f, zeros, sec->offset - *at);
+  if (sec->stored)
+    pcu_write(f, data, sec->stored);
+  *at = sec->offset + sec->stored;
+}
+
+static uint32_t* pack_class(struct mds_apf* m, size_t* bytes)
+{
+  uint32_t* class;
+  uint32_t* p;
+  size_t n = 0;
+  int i;
+  int type_mds;
+  mds_id j;
+  struct gmi_ent* model;
+  for (i = 0; i < MDS_TYPES; ++i)
+    n += m->mds.end[i];
+  *bytes = 2 * n * sizeof(uint32_t);
+  class = malloc(*bytes);
+  p = class;
+  for (i = 0; i < SMB_TYPES; ++i) {
+    type_mds = smb2mds(i);
+    for (j = 0; j < m->mds.end[type_mds]; ++j) {
+      model = m->model[type_mds][j];
+      p[0] = mds_model_id(m, model);
+      p[1] = mds_model_dim(m, model);
+      p += 2;
+    }
+  }
+  return class;
+}
+
+/* see map_remotes */
+static unsigned* pack_remotes(PCU_t h, struct mds_apf* m, int ignore_peers,
+    size_t* bytes)
+{
+  struct mds_links ln = MDS_LINKS_INIT;
+  unsigned* w;
+  size_t nw;
+  unsigned i;
+  if (!ignore_peers)
+    mds_get_type_links(h, &m->remotes, &m->mds, MDS_VERTEX, &ln);
+  nw = 1 + 2 * (size_t)ln.np;
+  for (i = 0; i < ln.np; ++i)
+    nw += ln.n[i];
+  w = malloc(nw * sizeof(unsigned));
+  w[0] = ln.np;
+  if (ln.np) {
+    memcpy(w + 1, ln.p, ln.np * sizeof(unsigned));
+    memcpy(w + 1 + ln.np, ln.n, ln.np * sizeof(unsigned));
+  }
+  nw = 1 + 2 * (size_t)ln.np;
+  for (i = 0; i < ln.np; ++i) {
+    memcpy(w + nw, ln.l[i], ln.n[i] * sizeof(unsigned));
+    nw += ln.n[i];
+  }
+  mds_free_links(&ln);
+  *bytes = nw * sizeof(unsigned);
+  return w;
+}
+
+static char* pack_stream(PCU_t h, struct mds_apf* m, int ignore_peers,
+    void* apf_mesh, size_t* bytes)
+{
+  char* data;
+  struct pcu_file* f;
+  f = pcu_fmemopen_write(&data, bytes);
+  write_tags(f, m);
+  write_matches(h, f, m, ignore_peers);
+  mds_write_smb_meta(f, apf_mesh);
+  pcu_fclose(f);
+  return data;
+}
+
+static void set_section(struct smb_toc* toc, int s, size_t bytes, int codec)
+{
+  toc->sections[s].bytes = bytes;
+  toc->sections[s].codec = codec;
+}
+
+/* the MDS downward arrays of a compact mesh are exactly
+   the connectivity sections */
+static void write_sections(PCU_t h, struct pcu_file* f, struct mds_apf* m,
+    int compress, int ignore_peers, void* apf_mesh)
+{
+  struct smb_toc toc;
+  struct smb_section* sec;
+  void const* data[SMB_SECTIONS] = {NULL};
+  void* owned[SMB_SECTIONS] = {NULL};
+  int word[SMB_SECTIONS];
+  size_t bytes;
+  size_t nv;
+  uint64_t at;
+  int i;
+  int type_mds;
+  memset(&toc, 0, sizeof(toc));
+  toc.byte_order = SMB_BYTE_ORDER;
+  toc.id_bytes = sizeof(mds_id);
+  toc.nsections = SMB_SECTIONS;
+  for (i = 0; i < MDS_TYPES; ++i)
+    toc.n[mds2smb(i)] = m->mds.end[i];
+  nv = toc.n[SMB_VERT];
+  data[SMB_SEC_COORDS] = m->point;
+  word[SMB_SEC_COORDS] = 8;
+  set_section(&toc, SMB_SEC_COORDS, nv * sizeof(m->point[0]),
+      MDS_CODEC_ZLIB);
+  data[SMB_SEC_PARAMS] = m->param;
+  word[SMB_SEC_PARAMS] = 8;
+  set_section(&toc, SMB_SEC_PARAMS, nv * sizeof(m->param[0]),
+      MDS_CODEC_ZLIB);
+  data[SMB_SEC_CLASS] = owned[SMB_SEC_CLASS] = pack_class(m, &bytes);
+  word[SMB_SEC_CLASS] = 4;
+  set_section(&toc, SMB_SEC_CLASS, bytes, MDS_CODEC_ZLIB);
+  data[SMB_SEC_REMOTES] = owned[SMB_SEC_REMOTES] =
+    pack_remotes(h, m, ignore_peers, &bytes);
+  word[SMB_SEC_REMOTES] = 4;
+  set_section(&toc, SMB_SEC_REMOTES, bytes, MDS_CODEC_DELTA);
+  for (i = 0; i < SMB_TYPES; ++i) {
+    type_mds = smb2mds(i);
+    word[SMB_SEC_CONN + i] = sizeof(mds_id);
+    if (i)
+      data[SMB_SEC_CONN + i] = m->mds.down[mds_dim[type_mds] - 1][type_mds];
+    set_section(&toc, SMB_SEC_CONN + i, i ?
+        (size_t)toc.n[i] * down_degree(type_mds) * sizeof(mds_id) : 0,
+        MDS_CODEC_DELTA);
+  }
+  data[SMB_SEC_STREAM] = owned[SMB_SEC_STREAM] =
+    pack_stream(h, m, ignore_peers, apf_mesh, &bytes);
+  word[SMB_SEC_STREAM] = 1;
+  set_section(&toc, SMB_SEC_STREAM, bytes, MDS_CODEC_ZLIB);
+  at = SMB_HEADER_BYTES + sizeof(toc);
+  for (i = 0; i < SMB_SECTIONS; ++i) {
+    sec = &toc.sections[i];
+    if (!compress)
+      sec->codec = MDS_CODEC_RAW;
+    if (sec->codec == MDS_CODEC_RAW) {
+      sec->stored = sec->bytes;
+    } else {
+      data[i] = mds_encode(sec->codec, data[i], sec->bytes, word[i],
+          &bytes);
+      free(owned[i]);
+      owned[i] = (void*)data[i];
+      sec->stored = bytes;
+    }
+    sec->offset = align_section(at);
+    at = sec->offset + sec->stored;
+  }
+  pcu_write(f, (char const*)&toc, sizeof(toc));
+  at = SMB_HEADER_BYTES + sizeof(toc);
+  for (i = 0; i < SMB_SECTIONS; ++i)
+    write_section(f, &at, &toc.sections[i], data[i]);
+  for (i = 0; i < SMB_SECTIONS; ++i)
+    free(owned[i]);
+}
+
 static void write_smb(PCU_t h, struct mds_apf* m, const char* filename,
-    int zip, int ignore_peers, void* apf_mesh)
+    int file, int zip, int ignore_peers, void* apf_mesh)
 {
   struct pcu_file* f;
   unsigned n[SMB_TYPES] = {0};
   int i;
-  f = pcu_fopen(h, filename, 1, zip);
+  f = open_smb(h, filename, file, 1, zip);
   PCU_ALWAYS_ASSERT(f);
-  write_header(h, f, m->mds.d, ignore_peers);
+  if (zip != SMB_BZ2) {
+    write_header(h, f, SMB_VERSION, m->mds.d, ignore_peers);
+    write_sections(h, f, m, zip == SMB_ZLIB, ignore_peers, apf_mesh);
+    pcu_fclose(f);
+    return;
+  }
+  write_header(h, f, SMB_STREAM_VERSION, m->mds.d, ignore_peers);
   for (i = 0; i < MDS_TYPES; ++i)
     n[mds2smb(i)] = m->mds.end[i];
   pcu_write_unsigneds(f, n, SMB_TYPES);
@@ -678,6 +1092,8 @@ static void append(char* s, size_t size, const char* format, ...)
 }
 
 #define SMB_FANOUT 2048
+/* the most parts in one shared file, see handle_path */
+#define SMB_SHARED_PARTS 4096
 
 static void safe_mkdir(const char* path, mode_t mode)
 {
@@ -688,11 +1104,18 @@ static void safe_mkdir(const char* path, mode_t mode)
     reel_fail("MDS: could not create directory \"%s\"\n", path);
 }
 
+/* "a/" names the files a/N.smb, "a.smb" names the files aN.smb,
+   one per part N. "a.psmb" names one file a.psmb shared by all
+   parts, or with more than SMB_SHARED_PARTS parts, the files
+   aK.psmb that each hold SMB_SHARED_PARTS consecutive parts.
+   *file is then the index K, and is -1 otherwise. */
 static char* handle_path(PCU_t h, const char* in, int is_write, int* zip,
-    int ignore_peers)
+    int ignore_peers, int* file)
 {
   static const char* zippre = "bz2:";
+  static const char* zlibpre = "zip:";
   static const char* smbext = ".smb";
+  static const char* sharedext = ".psmb";
   size_t bufsize;
   char* path;
   mode_t const dir_perm = S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH;
@@ -701,10 +1124,27 @@ static char* handle_path(PCU_t h, const char* in, int is_write, int* zip,
   path = malloc(bufsize);
   strcpy(path, in);
   if (starts_with(path, zippre)) {
-    *zip = 1;
+    *zip = SMB_BZ2;
     remove_prefix(path, zippre);
+  } else if (starts_with(path, zlibpre)) {
+    *zip = SMB_ZLIB;
+    remove_prefix(path, zlibpre);
   } else {
-    *zip = 0;
+    *zip = SMB_PLAIN;
+  }
+  *file = -1;
+  if (ends_with(path, sharedext)) {
+    /* a serial mesh is a shared file of one part */
+    if (ignore_peers) {
+      *file = self;
+      return path;
+    }
+    *file = self / SMB_SHARED_PARTS;
+    if (PCU_Comm_Peers(h) > SMB_SHARED_PARTS) {
+      remove_ext(path, sharedext);
+      append(path, bufsize, "%d%s", *file, sharedext);
+    }
+    return path;
   }
   if (ignore_peers)
     return path;
@@ -736,9 +1176,10 @@ struct mds_apf* mds_read_smb(PCU_t h, struct gmi_model* model, const char* pathn
 {
   char* filename;
   int zip;
+  int file;
   struct mds_apf* m;
-  filename = handle_path(h, pathname, 0, &zip, ignore_peers);
-  m = read_smb(h, model, filename, zip, ignore_peers, apf_mesh);
+  filename = handle_path(h, pathname, 0, &zip, ignore_peers, &file);
+  m = read_smb(h, model, filename, file, zip, ignore_peers, apf_mesh);
   free(filename);
   return m;
 }
@@ -758,6 +1199,7 @@ struct mds_apf* mds_write_smb(PCU_t h, struct mds_apf* m, const char* pathname,
   const char* reorderWarning ="MDS: reordering before writing smb files\n";
   char* filename;
   int zip;
+  int file;
   if (ignore_peers && (!is_compact(m))) {
     if(!PCU_Comm_Self(h)) lion_eprint(1, "%s", reorderWarning);
     m = mds_reorder(h, m, 1, mds_number_verts_bfs(m));
@@ -766,8 +1208,8 @@ struct mds_apf* mds_write_smb(PCU_t h, struct mds_apf* m, const char* pathname,
     if(!PCU_Comm_Self(h)) lion_eprint(1, "%s", reorderWarning);
     m = mds_reorder(h, m, 0, mds_number_verts_bfs(m));
   }
-  filename = handle_path(h, pathname, 1, &zip, ignore_peers);
-  write_smb(h, m, filename, zip, ignore_peers, apf_mesh);
+  filename = handle_path(h, pathname, 1, &zip, ignore_peers, &file);
+  write_smb(h, m, filename, file, zip, ignore_peers, apf_mesh);
   free(filename);
   return m;
 }
@@ -16,6 +16,8 @@ set(MDS_SOURCES
   mds_smb.c
   mds_tag.c
   apfMDS.cc
+  apfMDSParallel.cc
+  mdsCodec.cc
   apfPM.cc
   apfBox.cc
   mdsANSYS.cc
@@ -4,8 +4,12 @@
 #include "pcu_mpi.h"
 #include "pcu_msg.h"
 #include "pcu_order.h"
+#include "pcu_prof.h"
 #include "reel.h"
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
 #include <sys/stat.h> /*using POSIX mkdir call for SMB "foo/" path*/
 #include <climits>
 #include <cstring>
@@ -14,7 +18,16 @@
 #include <time.h>
 namespace pcu {
 
+/* threads are numbered in the order they first use PCU,
+   starting with the one that calls Init */
+static int thread_index() {
+  static std::atomic<int> count(0);
+  thread_local int index = count++;
+  return index;
+}
+
 void Init(int *argc, char ***argv) {
+  thread_index();
 #ifndef SCOREC_NO_MPI
   int flag;
   MPI_Initialized(&flag);
@@ -24,6 +37,28 @@ void Init(int *argc, char ***argv) {
 #endif
 }
 
+void InitThreads(int *argc, char ***argv) {
+  thread_index();
+#ifndef SCOREC_NO_MPI
+  int flag;
+  MPI_Initialized(&flag);
+  int provided;
+  if (!flag) MPI_Init_thread(argc, argv, MPI_THREAD_MULTIPLE, &provided);
+#else
+  (void) argc, (void) argv;
+#endif
+}
+
+bool MultipleThreads() noexcept {
+#ifndef SCOREC_NO_MPI
+  int provided;
+  MPI_Query_thread(&provided);
+  return provided == MPI_THREAD_MULTIPLE;
+#else
+  return true;
+#endif
+}
+
 void Finalize() {
 #ifndef SCOREC_NO_MPI
   int flag;
@@ -34,7 +69,21 @@ void Finalize() {
 
 int PCU::Peers() const noexcept { return pcu_mpi_size(mpi_); }
 int PCU::Self() const noexcept { return pcu_mpi_rank(mpi_); }
-void PCU::Begin() noexcept { pcu_msg_start(mpi_, msg_); }
+#if defined(__GNUC__)
+#define PCU_CALL_SITE __builtin_return_address(0)
+#else
+#define PCU_CALL_SITE nullptr
+#endif
+void PCU::Begin() noexcept {
+  if (msg_->prof)
+    pcu_prof_begin(msg_->prof, nullptr, PCU_CALL_SITE);
+  pcu_msg_start(mpi_, msg_);
+}
+void PCU::Begin(const char* label) noexcept {
+  if (msg_->prof)
+    pcu_prof_begin(msg_->prof, label, PCU_CALL_SITE);
+  pcu_msg_start(mpi_, msg_);
+}
 int PCU::Pack(int to_rank, const void *data, size_t size) noexcept {
   if ((to_rank < 0) || (to_rank >= Peers()))
     reel_fail("Invalid rank in Comm_Pack");
@@ -47,6 +96,29 @@ int PCU::Pack(int to_rank, const void *data, size_t size) noexcept {
   return PCU_SUCCESS;
 }
 
+void PCU::Count(int to_rank, size_t size) noexcept {
+  if ((to_rank < 0) || (to_rank >= Peers()))
+    reel_fail("Invalid rank in Comm_Count");
+  pcu_msg_count(msg_, to_rank, size);
+}
+
+void* PCU::Reserve(int to_rank, size_t size) noexcept {
+  if ((to_rank < 0) || (to_rank >= Peers()))
+    reel_fail("Invalid rank in Comm_Reserve");
+  if (size > (size_t)INT_MAX) {
+    fprintf(stderr, "ERROR Attempting to pack a PCU message whose size exceeds "
+                    "INT_MAX... exiting\n");
+    abort();
+  }
+  return pcu_msg_pack(msg_, to_rank, size);
+}
+
+void PCU::Flush(int to_rank) noexcept {
+  if ((to_rank < 0) || (to_rank >= Peers()))
+    reel_fail("Invalid rank in Comm_Flush");
+  pcu_msg_flush(mpi_, msg_, to_rank);
+}
+
 int PCU::Send() noexcept {
   pcu_msg_send(mpi_, msg_);
   return PCU_SUCCESS;
@@ -58,9 +130,14 @@ bool PCU::Receive() noexcept {
   return true;
 }
 bool PCU::Listen() noexcept {
+  bool got;
   if (msg_->order)
-    return pcu_order_receive(mpi_, msg_->order, msg_);
-  return pcu_msg_receive(mpi_, msg_);
+    got = pcu_order_receive(mpi_, msg_->order, msg_);
+  else
+    got = pcu_msg_receive(mpi_, msg_);
+  if (!got && msg_->prof)
+    pcu_prof_end(msg_->prof, &(msg_->counts));
+  return got;
 }
 int PCU::Sender() noexcept {
   if (msg_->order)
@@ -103,6 +180,9 @@ void PCU::Order(bool on) {
     msg_->order = NULL;
   }
 }
+void PCU::Neighbors(const int* peers, int n) {
+  pcu_msg_set_neighbors(mpi_, msg_, peers, n);
+}
 void PCU::Barrier() { pcu_barrier(mpi_, &(msg_->coll)); }
 int PCU::Or(int c) noexcept { return Max(c); }
 int PCU::And(int c) noexcept { return Min(c); }
@@ -113,6 +193,16 @@ std::unique_ptr<PCU> PCU::Split(int color, int key) noexcept {
   PCU* splitpcu = new PCU(newcomm);
   return std::unique_ptr<PCU>(splitpcu);
 }
+std::unique_ptr<PCU> PCU::Dup() noexcept {
+  PCU_Comm newcomm;
+  DupComm(&newcomm);
+  std::unique_ptr<PCU> dup(new PCU(newcomm));
+#ifndef SCOREC_NO_MPI
+  /* the new object made its own copies */
+  MPI_Comm_free(&newcomm);
+#endif
+  return dup;
+}
 int PCU::DupComm(PCU_Comm* newcomm) const noexcept {
   return pcu_mpi_dup(mpi_, newcomm);
 }
@@ -176,6 +266,9 @@ void PCU::DebugOpen() noexcept {
   }
 
   append(path, bufsize, "%s", "debug");
+  int thread = thread_index();
+  if (thread)
+    append(path, bufsize, "-t%d-", thread);
   if (!msg_->file)
     msg_->file = pcu_open_parallel(GetCHandle(), path, "txt");
   noto_free(path);
@@ -185,15 +278,7 @@ void PCU::DebugOpen() noexcept {
 
 double GetMem() noexcept { return pcu_get_mem(); }
 void Protect() noexcept { reel_protect(); }
-double Time() noexcept {
-#ifndef SCOREC_NO_MPI
-  return MPI_Wtime();
-#else
-  struct timespec now;
-  clock_gettime(CLOCK_REALTIME, &now);
-  return (double)now.tv_sec + now.tv_nsec * 1.0e-9;
-#endif
-}
+double Time() noexcept { return pcu_mpi_time(); }
 
 void PCU::DebugPrint(const char *format, ...) noexcept {
   va_list args;
@@ -225,6 +310,8 @@ PCU::PCU(PCU_Comm comm) {
   Order(true);
 }
 PCU::~PCU() noexcept {
+  if (msg_->prof)
+    Profile(nullptr);
   pcu_mpi_finalize(mpi_);
   delete mpi_;
   if (msg_->order) pcu_order_free(msg_->order);
@@ -241,69 +328,113 @@ PCU &PCU::operator=(PCU && other) noexcept {
   return *this;
 }
 
+void PCU::NativeCollectives(bool on) noexcept { mpi_->native_coll = on; }
+bool PCU::NativeCollectives() const noexcept { return mpi_->native_coll; }
+
+void PCU::SharedMemory(size_t capacity) {
+  pcu_mpi_shared(mpi_, capacity);
+}
+
+void PCU::Hierarchy(bool on, int node_size) {
+  pcu_mpi_set_nodes(mpi_, on, node_size);
+}
+
+void PCU::Profile(const char* path) {
+  /* the gather that writes the profile is not profiled */
+  pcu_prof* old = msg_->prof;
+  msg_->prof = nullptr;
+  if (old) {
+    pcu_prof_write(old, *this);
+    pcu_prof_free(old);
+  }
+  if (path)
+    msg_->prof = pcu_prof_new(path);
+}
+
+/* the built-in types of the native collectives */
+template <typename T> struct MpiType;
+template <> struct MpiType<int> {
+  static constexpr pcu_mpi_type value = PCU_MPI_INT;
+};
+template <> struct MpiType<long> {
+  static constexpr pcu_mpi_type value = PCU_MPI_LONG;
+};
+template <> struct MpiType<size_t> {
+  static constexpr pcu_mpi_type value = PCU_MPI_SIZE_T;
+};
+template <> struct MpiType<double> {
+  static constexpr pcu_mpi_type value = PCU_MPI_DOUBLE;
+};
+
+/* merges of the tree collectives */
+template <typename T>
+static void mergeAdd(int, int, void *local, void *incoming, size_t size) {
+  auto *a = static_cast<T *>(local);
+  auto *b = static_cast<T *>(incoming);
+  size_t n = size / sizeof(T);
+  for (size_t i = 0; i < n; ++i)
+    a[i] += b[i];
+}
+template <typename T>
+static void mergeMin(int, int, void *local, void *incoming, size_t size) {
+  auto *a = static_cast<T *>(local);
+  auto *b = static_cast<T *>(incoming);
+  size_t n = size / sizeof(T);
+  for (size_t i = 0; i < n; ++i)
+    a[i] = std::min(a[i], b[i]);
+}
+template <typename T>
+static void mergeMax(int, int, void *local, void *incoming, size_t size) {
+  auto *a = static_cast<T *>(local);
+  auto *b = static_cast<T *>(incoming);
+  size_t n = size / sizeof(T);
+  for (size_t i = 0; i < n; ++i)
+    a[i] = std::max(a[i], b[i]);
+}
+
 /* template implementations */
 template <typename T> void PCU::Add(T *p, size_t n) noexcept {
-  pcu_allreduce(
-      mpi_, &(msg_->coll),
-      [](int, int, void *local, void *incoming, size_t size) {
-        auto *a = static_cast<T *>(local);
-        auto *b = static_cast<T *>(incoming);
-        size_t n = size / sizeof(T);
-        for (size_t i = 0; i < n; ++i)
-          a[i] += b[i];
-      },
-      p, n * sizeof(T));
+  if (mpi_->native_coll) {
+    pcu_mpi_allreduce(mpi_, p, n, MpiType<T>::value, PCU_MPI_SUM);
+    return;
+  }
+  pcu_allreduce(mpi_, &(msg_->coll), mergeAdd<T>, p, n * sizeof(T));
 }
 template <typename T> T PCU::Add(T p) noexcept {
   Add(&p, 1);
   return p;
 }
 template <typename T> void PCU::Min(T *p, size_t n) noexcept {
-  pcu_allreduce(
-      mpi_, &(msg_->coll),
-      [](int, int, void *local, void *incoming, size_t size) {
-        auto *a = static_cast<T *>(local);
-        auto *b = static_cast<T *>(incoming);
-        size_t n = size / sizeof(T);
-        for (size_t i = 0; i < n; ++i)
-          a[i] = std::min(a[i], b[i]);
-      },
-      p, n * sizeof(T));
+  if (mpi_->native_coll) {
+    pcu_mpi_allreduce(mpi_, p, n, MpiType<T>::value, PCU_MPI_MIN);
+    return;
+  }
+  pcu_allreduce(mpi_, &(msg_->coll), mergeMin<T>, p, n * sizeof(T));
 }
 template <typename T> T PCU::Min(T p) noexcept {
   Min(&p, 1);
   return p;
 }
 template <typename T> void PCU::Max(T *p, size_t n) noexcept {
-  pcu_allreduce(
-      mpi_, &(msg_->coll),
-      [](int, int, void *local, void *incoming, size_t size) {
-        auto *a = static_cast<T *>(local);
-        auto *b = static_cast<T *>(incoming);
-        size_t n = size / sizeof(T);
-        for (size_t i = 0; i < n; ++i)
-          a[i] = std::max(a[i], b[i]);
-      },
-      p, n * sizeof(T));
+  if (mpi_->native_coll) {
+    pcu_mpi_allreduce(mpi_, p, n, MpiType<T>::value, PCU_MPI_MAX);
+    return;
+  }
+  pcu_allreduce(mpi_, &(msg_->coll), mergeMax<T>, p, n * sizeof(T));
 }
 template <typename T> T PCU::Max(T p) noexcept {
   Max(&p, 1);
   return p;
 }
 template <typename T> void PCU::Exscan(T *p, size_t n) noexcept {
+  if (mpi_->native_coll) {
+    pcu_mpi_exscan(mpi_, p, n, MpiType<T>::value);
+    return;
+  }
   auto *originals = (T *)noto_malloc(sizeof(T) * n);
   for (size_t i = 0; i < n; ++i)
     originals[i] = p[i];
-  pcu_scan(
-      mpi_, &(msg_->coll),
-      [](int, int, void *local, void *incoming, size_t size) {
-        auto *a = static_cast<T *>(local);
-        auto *b = static_cast<T *>(incoming);
-        size_t n = size / sizeof(T);
-        for (size_t i = 0; i < n; ++i)
-          a[i] += b[i];
-      },
-      p, n * sizeof(T));
+  pcu_scan(mpi_, &(msg_->coll), mergeAdd<T>, p, n * sizeof(T));
   // convert inclusive scan to exclusive
   for (size_t i = 0; i < n; ++i)
     p[i] -= originals[i];
@@ -316,9 +447,103 @@ template <typename T> T PCU::Exscan(T p) noexcept {
 
 template <typename T>
 void PCU::Allgather(const T *send_data, T *recv_data, size_t n) noexcept {
+  if (mpi_->native_coll) {
+    pcu_mpi_allgather(mpi_, send_data, recv_data, n, MpiType<T>::value);
+    return;
+  }
   pcu_allgather(mpi_, &(msg_->coll), send_data, recv_data, n * sizeof(T));
 }
 
+struct Request::State {
+  pcu_mpi_t *mpi;
+  bool native;
+  PCU_Request request;
+  pcu_icoll coll;
+  /* runs once the communication is done */
+  std::function<void()> finish;
+};
+
+Request::Request() noexcept {}
+Request::Request(State *state) noexcept : state_(state) {}
+Request::~Request() noexcept { Wait(); }
+Request::Request(Request &&other) noexcept
+    : state_(std::move(other.state_)) {}
+Request &Request::operator=(Request &&other) noexcept {
+  if (this != &other) {
+    Wait();
+    state_ = std::move(other.state_);
+  }
+  return *this;
+}
+bool Request::Test() noexcept {
+  if (!state_)
+    return true;
+  if (state_->native) {
+    if (!pcu_mpi_test(state_->mpi, &(state_->request)))
+      return false;
+  } else if (pcu_progress_icoll(state_->mpi, &(state_->coll))) {
+    return false;
+  }
+  if (state_->finish)
+    state_->finish();
+  state_.reset();
+  return true;
+}
+void Request::Wait() noexcept {
+  while (!Test());
+}
+
+/* the tree collectives of each request get their own tag,
+   so they do not mix with those started in the meantime */
+static int nextTag(pcu_msg *msg) {
+  msg->icoll_tag = msg->icoll_tag % 1024 + 1;
+  return msg->icoll_tag;
+}
+
+template <typename T>
+static Request beginAllreduce(pcu_mpi_t *mpi, pcu_msg *msg, T *p, size_t n,
+                              pcu_mpi_op op, pcu_merge *merge) {
+  auto *state = new Request::State();
+  state->mpi = mpi;
+  state->native = mpi->native_coll;
+  if (state->native)
+    pcu_mpi_iallreduce(mpi, p, n, MpiType<T>::value, op, &(state->request));
+  else
+    pcu_begin_allreduce(mpi, &(state->coll), merge, p, n * sizeof(T),
+                        nextTag(msg));
+  return Request(state);
+}
+
+template <typename T> Request PCU::IAdd(T *p, size_t n) noexcept {
+  return beginAllreduce(mpi_, msg_, p, n, PCU_MPI_SUM, mergeAdd<T>);
+}
+template <typename T> Request PCU::IMin(T *p, size_t n) noexcept {
+  return beginAllreduce(mpi_, msg_, p, n, PCU_MPI_MIN, mergeMin<T>);
+}
+template <typename T> Request PCU::IMax(T *p, size_t n) noexcept {
+  return beginAllreduce(mpi_, msg_, p, n, PCU_MPI_MAX, mergeMax<T>);
+}
+template <typename T> Request PCU::IExscan(T *p, size_t n) noexcept {
+  auto *state = new Request::State();
+  state->mpi = mpi_;
+  state->native = mpi_->native_coll;
+  if (state->native) {
+    pcu_mpi_iexscan(mpi_, p, n, MpiType<T>::value, &(state->request));
+    if (!Self())
+      state->finish = [p, n]() { std::fill(p, p + n, T(0)); };
+  } else {
+    std::vector<T> originals(p, p + n);
+    pcu_begin_scan(mpi_, &(state->coll), mergeAdd<T>, p, n * sizeof(T),
+                   nextTag(msg_));
+    // convert inclusive scan to exclusive
+    state->finish = [p, originals]() {
+      for (size_t i = 0; i < originals.size(); ++i)
+        p[i] -= originals[i];
+    };
+  }
+  return Request(state);
+}
+
 #define PCU_EXPL_INST_DECL(T)                                                  \
   template void PCU::Add<T>(T * p, size_t n) noexcept;                         \
   template T PCU::Add<T>(T p) noexcept;                                        \
@@ -328,7 +553,11 @@ void PCU::Allgather(const T *send_data, T *recv_data, size_t n) noexcept {
   template T PCU::Max<T>(T p) noexcept;                                        \
   template void PCU::Exscan<T>(T * p, size_t n) noexcept;                      \
   template T PCU::Exscan<T>(T p) noexcept;                                     \
-  template void PCU::Allgather<T>(const T *in, T *out, size_t n) noexcept;
+  template void PCU::Allgather<T>(const T *in, T *out, size_t n) noexcept;     \
+  template Request PCU::IAdd<T>(T * p, size_t n) noexcept;                     \
+  template Request PCU::IMin<T>(T * p, size_t n) noexcept;                     \
+  template Request PCU::IMax<T>(T * p, size_t n) noexcept;                     \
+  template Request PCU::IExscan<T>(T * p, size_t n) noexcept;
 PCU_EXPL_INST_DECL(int)
 PCU_EXPL_INST_DECL(size_t)
 PCU_EXPL_INST_DECL(long)
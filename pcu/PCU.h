@@ -9,6 +9,9 @@
 #include <memory>
 #include <cstdlib>
 #include <cstdarg> //va_list
+#include <cstring>
+#include <type_traits>
+#include <vector>
 #include "pcu_defines.h"
 
 struct pcu_msg_struct;
@@ -20,8 +23,42 @@ struct pcu_mpi_struct;
  * All C++ PCU symbols are contained in this namespace.
  */
 namespace pcu {
+/**
+ * \brief A pending non-blocking collective operation, see PCU::IAdd.
+ *
+ * The data given to the operation must stay in place until Test returns
+ * true or Wait returns. Destroying a pending request waits for it.
+ */
+class Request {
+public:
+  struct State;
+  Request() noexcept;
+  explicit Request(State* state) noexcept;
+  ~Request() noexcept;
+  Request(Request const &) = delete;
+  Request(Request &&) noexcept;
+  Request &operator=(Request const &) = delete;
+  Request &operator=(Request &&) noexcept;
+  /** \brief Makes progress on the operation.
+   *  \return true if it is done.
+   */
+  bool Test() noexcept;
+  /** \brief Blocks until the operation is done. */
+  void Wait() noexcept;
+
+private:
+  std::unique_ptr<State> state_;
+};
+
 /**
  * \brief The Parallel Contrul Unit class encapsulates parallel communication.
+ *
+ * PCU objects share no state, so threads may each use their own object at
+ * the same time, given that MPI was initialized with InitThreads and
+ * MultipleThreads returns true. The objects usually come from Dup, called
+ * on one thread before the others start. A single object must not be used
+ * by two threads at once, and collectives over objects that share ranks
+ * must be created in the same order on every rank.
  */
 class PCU {
 public:
@@ -44,10 +81,34 @@ public:
   [[nodiscard]] PCU_t GetCHandle() {PCU_t h; h.ptr=this; return h;}
   /*recommended message passing API*/
   void Begin() noexcept;
+  /** \brief Begin a phase, filed under \a label by the profiler. */
+  void Begin(const char* label) noexcept;
   int Pack(int to_rank, const void *data, size_t size) noexcept;
   template<typename T> int Pack(int to_rank, const T& data) noexcept {
     return Pack(to_rank, &(data), sizeof(data));
   }
+  /**
+   * \brief Declare that size more bytes will be packed for to_rank.
+   *
+   * Counts are optional and must come before the first Pack of a phase.
+   * The first Pack then sizes every counted buffer at once, as slices
+   * of one allocation that later phases reuse. Packing more than was
+   * counted still works, at the cost of a copy.
+   */
+  void Count(int to_rank, size_t size) noexcept;
+  /**
+   * \brief Append size bytes to the buffer for to_rank.
+   * \return Where the caller writes the bytes, valid until the next Pack.
+   */
+  void* Reserve(int to_rank, size_t size) noexcept;
+  /**
+   * \brief Start sending what was packed for to_rank so far.
+   *
+   * Later packs for to_rank go in a new message, and the receiver gets
+   * the messages from this rank in the order they were flushed. Only
+   * global phases without Order do this; otherwise it does nothing.
+   */
+  void Flush(int to_rank) noexcept;
 
   int Send() noexcept;
   bool Receive() noexcept;
@@ -58,6 +119,51 @@ public:
   template<typename T> int Unpack(T& data) noexcept {
     return Unpack(&(data), sizeof(data));
   }
+  /**
+   * \brief Pack the n values at data with a single copy.
+   *
+   * T must be trivially copyable. The receiver calls UnpackArray
+   * with the same n.
+   */
+  template<typename T>
+  int PackArray(int to_rank, const T* data, size_t n) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "PackArray needs trivially copyable values");
+    if (!n)
+      return PCU_SUCCESS;
+    return Pack(to_rank, data, n * sizeof(T));
+  }
+  /** \brief Unpack n values packed by PackArray into data. */
+  template<typename T> int UnpackArray(T* data, size_t n) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "UnpackArray needs trivially copyable values");
+    if (!n)
+      return PCU_SUCCESS;
+    return Unpack(data, n * sizeof(T));
+  }
+  /**
+   * \brief Pack n and then the n values at data, in one reservation.
+   *
+   * The receiver does not need to know n and calls UnpackSized.
+   */
+  template<typename T>
+  int PackSized(int to_rank, const T* data, size_t n) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "PackSized needs trivially copyable values");
+    char* at = static_cast<char*>(
+        Reserve(to_rank, sizeof(n) + n * sizeof(T)));
+    memcpy(at, &n, sizeof(n));
+    if (n)
+      memcpy(at + sizeof(n), data, n * sizeof(T));
+    return PCU_SUCCESS;
+  }
+  /** \brief Unpack values packed by PackSized, resizing data to fit. */
+  template<typename T> int UnpackSized(std::vector<T>& data) {
+    size_t n;
+    Unpack(n);
+    data.resize(n);
+    return UnpackArray(data.data(), n);
+  }
   /*IPComMan replacement API*/
   int Write(int to_rank, const void *data, size_t size) noexcept;
   bool Read(int *from_rank, void **data, size_t *size) noexcept;
@@ -66,6 +172,22 @@ public:
     above API on/off*/
   void Order(bool on);
 
+  /**
+   * \brief Restrict the above API to a fixed set of neighbors.
+   *
+   * Each following phase sends one message to every neighbor and ends
+   * once one came back from each, so that it costs no collective.
+   * This rank may then only pack for itself and its neighbors.
+   * The sets must be symmetric: if b is a neighbor of a then a
+   * is a neighbor of b. All ranks have to switch modes between the
+   * same two phases; the set stays until changed by another call.
+   *
+   * \param peers the neighbor ranks, or nullptr to go back to
+   *              phases among all ranks.
+   * \param n the number of neighbor ranks.
+   */
+  void Neighbors(const int* peers, int n);
+
   /*collective operations*/
   void Barrier();
   template <typename T> void Add(T *p, size_t n) noexcept;
@@ -79,6 +201,64 @@ public:
   template <typename T>
   void Allgather(const T *send, T *recv, size_t n) noexcept;
 
+  /*non-blocking collective operations, which all
+    ranks must start in the same order*/
+  template <typename T> [[nodiscard]] Request IAdd(T *p, size_t n) noexcept;
+  template <typename T> [[nodiscard]] Request IMin(T *p, size_t n) noexcept;
+  template <typename T> [[nodiscard]] Request IMax(T *p, size_t n) noexcept;
+  template <typename T> [[nodiscard]] Request IExscan(T *p, size_t n) noexcept;
+
+  /**
+   * \brief Choose how the above operations communicate.
+   *
+   * With \a on (the default with MPI), they call the MPI collectives,
+   * which are usually tuned for the machine. Otherwise they use the PCU
+   * tree algorithms over point-to-point messages. All ranks must agree.
+   */
+  void NativeCollectives(bool on) noexcept;
+  /** \brief Returns true if the native MPI collectives are used. */
+  [[nodiscard]] bool NativeCollectives() const noexcept;
+
+  /**
+   * \brief Pass small messages between ranks of a node in shared memory.
+   *
+   * Messages of at most \a capacity bytes to ranks on the same node are
+   * then copied through an MPI-3 shared window instead of sent with MPI;
+   * larger ones and those to other nodes are unchanged. Every rank keeps
+   * two slots of \a capacity bytes for each rank of its node.
+   * Collective; call it between phases, with \a capacity zero to go
+   * back to MPI alone.
+   */
+  void SharedMemory(size_t capacity);
+
+  /**
+   * \brief Communicate through the nodes of the machine.
+   *
+   * With \a on, the native Add, Min and Max reduce within each node
+   * first and only one rank per node takes part in the global step.
+   * Global phases then send each message to another node through
+   * one rank of each node, so that every pair of nodes exchanges a
+   * single bundle; phases with Neighbors set are unchanged.
+   * Nodes are the ranks that share memory, or with \a node_size
+   * above zero, consecutive blocks of that many ranks.
+   * Collective; call it between phases.
+   */
+  void Hierarchy(bool on, int node_size = 0);
+
+  /**
+   * \brief Profile the phases of the message passing API.
+   *
+   * Each phase records its wall time, the time spent waiting in its
+   * barriers, and the messages and bytes it sent and received. Phases
+   * are totaled by the label given to Begin, or else by the function
+   * that called Begin. When profiling stops, rank 0 writes one row per
+   * rank and label to \a path.csv and the minimum, maximum and average
+   * over ranks of each label to \a path.json.
+   * Profiling stops on destruction or when called with nullptr.
+   * Collective; call it between phases.
+   */
+  void Profile(const char* path);
+
   /*bitwise operations*/
   [[nodiscard]] int Or(int c) noexcept;
   [[nodiscard]] int And(int c) noexcept;
@@ -96,6 +276,14 @@ public:
    */
   std::unique_ptr<PCU> Split(int color, int key) noexcept;
 
+  /**
+   * \brief Make an independent object over the same ranks.
+   *
+   * Collective. Its phases and collectives never interfere with those of
+   * this object, so it may be handed to another thread.
+   */
+  std::unique_ptr<PCU> Dup() noexcept;
+
   /**
    * \brief Duplicate the underlying communicator.
    *
@@ -127,6 +315,11 @@ public:
   void DebugPrint(const char* format, va_list args) noexcept;
   #endif // SWIG
   /* Debug functions */
+  /** \brief Open debugN.txt for DebugPrint, where N is the rank.
+   *
+   * Threads other than the one that called Init write to debug-tT-N.txt
+   * instead, T numbering the threads in the order they first used PCU.
+   */
   void DebugOpen() noexcept;
 
 private:
@@ -147,6 +340,20 @@ void Protect() noexcept;
  * the difference.
  */
 void Init(int *argc, char ***argv);
+/**
+ * \brief Initialize the parallel library for use from several threads.
+ *
+ * As Init, but asks MPI for MPI_THREAD_MULTIPLE. Check MultipleThreads
+ * for what was granted.
+ */
+void InitThreads(int *argc, char ***argv);
+/**
+ * \brief Returns true if threads may use their own PCU objects at once.
+ *
+ * This is whether MPI provides MPI_THREAD_MULTIPLE, and is always true
+ * without MPI.
+ */
+[[nodiscard]] bool MultipleThreads() noexcept;
 /**
  * \brief Finalize the underlying parallel library.
  *
@@ -171,7 +378,11 @@ void Finalize();
   extern template void PCU::Exscan<T>(T * p, size_t n) noexcept;               \
   extern template T PCU::Exscan<T>(T p) noexcept;                              \
   extern template                                                              \
-  void PCU::Allgather<T>(const T *send, T *recv, size_t n) noexcept;
+  void PCU::Allgather<T>(const T *send, T *recv, size_t n) noexcept;           \
+  extern template Request PCU::IAdd<T>(T * p, size_t n) noexcept;              \
+  extern template Request PCU::IMin<T>(T * p, size_t n) noexcept;              \
+  extern template Request PCU::IMax<T>(T * p, size_t n) noexcept;              \
+  extern template Request PCU::IExscan<T>(T * p, size_t n) noexcept;
 PCU_EXPL_INST_DECL(int)
 PCU_EXPL_INST_DECL(size_t)
 PCU_EXPL_INST_DECL(long)
@@ -32,6 +32,8 @@ void PCU_Comm_Begin(PCU_t h);
 int PCU_Comm_Pack(PCU_t h, int to_rank, const void* data, size_t size);
 #define PCU_COMM_PACK(handle, to_rank,object)\
 PCU_Comm_Pack(handle, to_rank,&(object),sizeof(object))
+void PCU_Comm_Count(PCU_t h, int to_rank, size_t size);
+void PCU_Comm_Flush(PCU_t h, int to_rank);
 int PCU_Comm_Send(PCU_t h);
 bool PCU_Comm_Receive(PCU_t h);
 bool PCU_Comm_Listen(PCU_t h);
@@ -45,6 +47,10 @@ PCU_Comm_Unpack(handle, &(object),sizeof(object))
   above API on/off*/
 void PCU_Comm_Order(PCU_t h, bool on);
 
+/*restricts the above API to a fixed set of
+  neighbors, or lifts that with peers = NULL*/
+void PCU_Comm_Neighbors(PCU_t h, const int* peers, int n);
+
 /*collective operations*/
 void PCU_Barrier(PCU_t h);
 void PCU_Add_Doubles(PCU_t h, double* p, size_t n);
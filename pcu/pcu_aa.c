@@ -42,7 +42,9 @@ bool pcu_aa_empty(pcu_aa_tree t)
 static void skew(pcu_aa_tree* t)
 {
   pcu_aa_tree temp;
-  if ((*t)->left->level == (*t)->level)
+  /* the bottom node is shared by every tree, so it is
+     never rotated, not even into itself */
+  if (*t != &pcu_aa_bottom && (*t)->left->level == (*t)->level)
   { /* rotate right */
     temp = *t;
     *t = (*t)->left;
@@ -0,0 +1,150 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_batch.h"
+#include "reel.h"
+
+namespace pcu {
+
+/* record sizes are written seven bits per byte, low bits first,
+   with the top bit set on every byte but the last, so records
+   below 128 bytes cost one byte of header */
+
+static size_t header_size(size_t size)
+{
+  size_t n = 1;
+  while (size >= 0x80) {
+    size >>= 7;
+    ++n;
+  }
+  return n;
+}
+
+static char* write_header(char* at, size_t size)
+{
+  while (size >= 0x80) {
+    *at++ = static_cast<char>((size & 0x7f) | 0x80);
+    size >>= 7;
+  }
+  *at++ = static_cast<char>(size);
+  return at;
+}
+
+static const char* read_header(const char* at, const char* end, size_t* size)
+{
+  int shift = 0;
+  *size = 0;
+  for (;;) {
+    if (at == end)
+      reel_fail("pcu::Batch: truncated record header");
+    unsigned char byte = static_cast<unsigned char>(*at++);
+    *size |= static_cast<size_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return at;
+    shift += 7;
+  }
+}
+
+Batch::Batch(PCU& pcu, size_t chunk, bool flush):
+  pcu_(pcu),
+  chunk_(chunk),
+  flush_(flush),
+  chunks_(pcu.Peers()),
+  at_(nullptr),
+  end_(nullptr),
+  record_(nullptr),
+  size_(0),
+  walked_(0)
+{
+}
+
+void Batch::Begin() noexcept
+{
+  pcu_.Begin();
+  at_ = end_ = record_ = nullptr;
+  size_ = walked_ = 0;
+}
+
+void Batch::Begin(const char* label) noexcept
+{
+  pcu_.Begin(label);
+  at_ = end_ = record_ = nullptr;
+  size_ = walked_ = 0;
+}
+
+void Batch::push(int to_rank)
+{
+  Chunk& c = chunks_[to_rank];
+  if (!c.used)
+    return;
+  pcu_.Pack(to_rank, c.data.data(), c.used);
+  if (flush_)
+    pcu_.Flush(to_rank);
+  c.used = 0;
+}
+
+void* Batch::Reserve(int to_rank, size_t size) noexcept
+{
+  if ((to_rank < 0) || (to_rank >= static_cast<int>(chunks_.size())))
+    reel_fail("Invalid rank in Batch::Reserve");
+  size_t need = header_size(size) + size;
+  Chunk& c = chunks_[to_rank];
+  if (c.used + need > chunk_)
+    push(to_rank);
+  /* records too large for a chunk go straight into the message */
+  if (need > chunk_) {
+    char* at = static_cast<char*>(pcu_.Reserve(to_rank, need));
+    return write_header(at, size);
+  }
+  if (c.data.empty())
+    c.data.resize(chunk_);
+  if (!c.used)
+    dirty_.push_back(to_rank);
+  char* at = write_header(c.data.data() + c.used, size);
+  c.used += need;
+  return at;
+}
+
+void Batch::Send() noexcept
+{
+  for (size_t i = 0; i < dirty_.size(); ++i)
+    push(dirty_[i]);
+  dirty_.clear();
+  pcu_.Send();
+}
+
+bool Batch::Receive() noexcept
+{
+  while (at_ == end_) {
+    if (!pcu_.Receive())
+      return false;
+    size_t size;
+    pcu_.Received(&size);
+    at_ = static_cast<const char*>(pcu_.Extract(size));
+    end_ = at_ + size;
+  }
+  at_ = read_header(at_, end_, &size_);
+  if (size_ > static_cast<size_t>(end_ - at_))
+    reel_fail("pcu::Batch: record overruns its message");
+  record_ = at_;
+  at_ += size_;
+  walked_ = 0;
+  return true;
+}
+
+void Batch::Unpack(void* data, size_t size) noexcept
+{
+  if (walked_ + size > size_)
+    reel_fail("pcu::Batch: unpacked past the end of a record");
+  if (size)
+    memcpy(data, record_ + walked_, size);
+  walked_ += size;
+}
+
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_BATCH_H
+#define PCU_BATCH_H
+
+/** \file pcu_batch.h
+  \brief Aggregation of many small records into few PCU messages */
+
+#include "PCU.h"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace pcu {
+
+/**
+ * \brief Sends many small records per phase in a few large messages.
+ *
+ * Records for a rank are copied into a staging chunk of fixed size,
+ * each after a header of one to a few bytes holding its size. A full
+ * chunk goes into the PCU message for that rank in one copy and, with
+ * flushing on, is sent right away so that it travels while the rest is
+ * packed. Records are then received one at a time, in the order each
+ * sender packed them.
+ *
+ * A Batch drives the phases of its PCU object, so no other packing or
+ * receiving may happen between its Begin and the end of its Receive.
+ */
+class Batch {
+public:
+  /** \brief Stage up to \a chunk bytes per rank, flushing full chunks
+   * early with \a flush. */
+  explicit Batch(PCU& pcu, size_t chunk = 4096, bool flush = false);
+  Batch(Batch const &) = delete;
+  Batch &operator=(Batch const &) = delete;
+
+  /** \brief Begin a phase of the PCU object. */
+  void Begin() noexcept;
+  /** \brief Begin a phase filed under \a label by the profiler. */
+  void Begin(const char* label) noexcept;
+  /**
+   * \brief Append a record of \a size bytes for \a to_rank.
+   * \return Where the caller writes the record, valid until the next
+   * Reserve or Pack.
+   */
+  void* Reserve(int to_rank, size_t size) noexcept;
+  void Pack(int to_rank, const void* data, size_t size) noexcept {
+    if (size)
+      memcpy(Reserve(to_rank, size), data, size);
+    else
+      Reserve(to_rank, 0);
+  }
+  template <typename T> void Pack(int to_rank, const T& record) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "Batch::Pack copies bytes");
+    Pack(to_rank, &record, sizeof(record));
+  }
+  /** \brief Send the staged records and end packing. */
+  void Send() noexcept;
+
+  /** \brief Move to the next record, false once all were received. */
+  bool Receive() noexcept;
+  /** \brief Returns the rank that packed the current record. */
+  [[nodiscard]] int Sender() noexcept { return pcu_.Sender(); }
+  /** \brief Returns the size of the current record. */
+  [[nodiscard]] size_t Size() const noexcept { return size_; }
+  /** \brief Returns the bytes of the current record. */
+  [[nodiscard]] const void* Data() const noexcept { return record_; }
+  /** \brief Copy the next \a size bytes of the current record. */
+  void Unpack(void* data, size_t size) noexcept;
+  template <typename T> void Unpack(T& data) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "Batch::Unpack copies bytes");
+    Unpack(&data, sizeof(data));
+  }
+  /** \brief Returns true once the current record was fully unpacked. */
+  [[nodiscard]] bool Unpacked() const noexcept { return walked_ == size_; }
+
+private:
+  struct Chunk {
+    std::vector<char> data;
+    size_t used = 0;
+  };
+  void push(int to_rank);
+  PCU& pcu_;
+  size_t chunk_;
+  bool flush_;
+  std::vector<Chunk> chunks_;
+  std::vector<int> dirty_;
+  const char* at_;
+  const char* end_;
+  const char* record_;
+  size_t size_;
+  size_t walked_;
+};
+
+}
+
+#endif
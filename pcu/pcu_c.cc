@@ -79,6 +79,27 @@ int PCU_Comm_Pack(PCU_t h, int to_rank, const void *data, size_t size) {
   return static_cast<pcu::PCU*>(h.ptr)->Pack(to_rank, data, size);
 }
 
+/** \brief Declares bytes that will be packed for a rank.
+  \details Calls to this function are optional and must precede
+  the first PCU_Comm_Pack of a phase, which then allocates all
+  the counted buffers at once.
+ */
+void PCU_Comm_Count(PCU_t h, int to_rank, size_t size) {
+  if (h.ptr == nullptr)
+    reel_fail("Comm_Count called before Comm_Init");
+  static_cast<pcu::PCU*>(h.ptr)->Count(to_rank, size);
+}
+
+/** \brief Starts sending what was packed for a rank so far.
+  \details Later packs for that rank go in a new message.
+  Phases with neighbors or ordering ignore this.
+ */
+void PCU_Comm_Flush(PCU_t h, int to_rank) {
+  if (h.ptr == nullptr)
+    reel_fail("Comm_Flush called before Comm_Init");
+  static_cast<pcu::PCU*>(h.ptr)->Flush(to_rank);
+}
+
 /** \brief Sends all buffers for this communication phase.
   \details This function should be called by all threads in the MPI job
   after calls to PCU_Comm_Pack or PCU_Comm_Write and before calls
@@ -146,6 +167,14 @@ void PCU_Comm_Order(PCU_t h, bool on) {
   static_cast<pcu::PCU*>(h.ptr)->Order(on);
 }
 
+/** \brief Restricts communication phases to a set of neighbors.
+  \details see pcu::PCU::Neighbors */
+void PCU_Comm_Neighbors(PCU_t h, const int* peers, int n) {
+  if (h.ptr == nullptr)
+    reel_fail("Comm_Neighbors called before Comm_Init");
+  static_cast<pcu::PCU*>(h.ptr)->Neighbors(peers, n);
+}
+
 /** \brief Blocking barrier over all threads. */
 void PCU_Barrier(PCU_t h) {
   if (h.ptr == nullptr)
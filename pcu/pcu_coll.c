@@ -44,7 +44,7 @@ static void begin_coll_step(pcu_mpi_t* mpi, pcu_coll* c)
     return;
   c->message.peer = c->pattern->peer(mpi, c->bit);
   if (action == pcu_coll_send)
-    pcu_mpi_send(mpi, &(c->message),mpi->coll_comm);
+    pcu_mpi_send2(mpi, &(c->message), c->tag, mpi->coll_comm);
 }
 
 /* tries to complete this communication step.
@@ -61,7 +61,7 @@ static bool end_coll_step(pcu_mpi_t* mpi, pcu_coll* c)
   pcu_message incoming;
   pcu_make_message(&incoming);
   incoming.peer = c->pattern->peer(mpi, c->bit);
-  if ( ! pcu_mpi_receive(mpi, &incoming,mpi->coll_comm))
+  if ( ! pcu_mpi_receive2(mpi, &incoming, c->tag, mpi->coll_comm))
     return false;
   if (c->message.buffer.size != incoming.buffer.size)
     reel_fail("PCU unexpected incoming message.\n"
@@ -78,6 +78,7 @@ void pcu_make_coll(pcu_mpi_t* mpi, pcu_coll* c, pcu_pattern* p, pcu_merge* m)
   (void)mpi;
   c->pattern = p;
   c->merge = m;
+  c->tag = 0;
 }
 
 /* the abstract algorithm for a collective communication
@@ -439,6 +440,43 @@ void pcu_allgather(pcu_mpi_t* mpi, pcu_coll* c, const void *send_data,
   pcu_bcast(mpi, c, recv_data, size * pcu_mpi_size(mpi));
 }
 
+static void begin_icoll(pcu_mpi_t* mpi, pcu_icoll* c, pcu_pattern* p,
+    pcu_merge* m, void* data, size_t size, int tag)
+{
+  pcu_make_coll(mpi, &(c->coll), p, m);
+  c->coll.tag = tag;
+  pcu_begin_coll(mpi, &(c->coll), data, size);
+}
+
+void pcu_begin_allreduce(pcu_mpi_t* mpi, pcu_icoll* c, pcu_merge* m,
+    void* data, size_t size, int tag)
+{
+  begin_icoll(mpi, c, &reduce, m, data, size, tag);
+  c->next = &bcast;
+  c->next_merge = pcu_merge_assign;
+}
+
+void pcu_begin_scan(pcu_mpi_t* mpi, pcu_icoll* c, pcu_merge* m,
+    void* data, size_t size, int tag)
+{
+  begin_icoll(mpi, c, &scan_up, m, data, size, tag);
+  c->next = &scan_down;
+  c->next_merge = m;
+}
+
+bool pcu_progress_icoll(pcu_mpi_t* mpi, pcu_icoll* c)
+{
+  if (pcu_progress_coll(mpi, &(c->coll)))
+    return true;
+  if (!c->next)
+    return false;
+  begin_icoll(mpi, c, c->next, c->next_merge,
+      c->coll.message.buffer.start, c->coll.message.buffer.size,
+      c->coll.tag);
+  c->next = NULL;
+  return true;
+}
+
 /* a barrier is just an allreduce of nothing in particular */
 void pcu_begin_barrier(pcu_mpi_t* mpi, pcu_coll* c)
 {
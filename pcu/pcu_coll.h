@@ -67,6 +67,7 @@ typedef struct
   pcu_merge* merge; //merge operation
   pcu_message message; //local data being operated on
   int bit; //pattern's state bit
+  int tag; //message tag, zero unless set after pcu_make_coll
 } pcu_coll;
 
 void pcu_make_coll(pcu_mpi_t *, pcu_coll* c, pcu_pattern* p, pcu_merge* m);
@@ -81,6 +82,24 @@ void pcu_scan(pcu_mpi_t*, pcu_coll* c, pcu_merge* m, void* data, size_t size);
 void pcu_allgather(pcu_mpi_t* mpi, pcu_coll* c, const void *send_data,
                    void *recv_data, size_t size);
 
+/* a non-blocking allreduce or scan, each being two collectives
+   run one after the other. They use their own message tag, so that
+   other collectives may run while they are in progress, as long as
+   all ranks start them in the same order. */
+typedef struct
+{
+  pcu_coll coll; //the collective in progress
+  pcu_pattern* next; //pattern of the second collective, if not started
+  pcu_merge* next_merge;
+} pcu_icoll;
+
+void pcu_begin_allreduce(pcu_mpi_t*, pcu_icoll* c, pcu_merge* m,
+    void* data, size_t size, int tag);
+void pcu_begin_scan(pcu_mpi_t*, pcu_icoll* c, pcu_merge* m,
+    void* data, size_t size, int tag);
+//returns false when done
+bool pcu_progress_icoll(pcu_mpi_t* mpi, pcu_icoll* c);
+
 void pcu_begin_barrier(pcu_mpi_t*,pcu_coll* c);
 bool pcu_barrier_done(pcu_mpi_t*, pcu_coll* c);
 void pcu_barrier(pcu_mpi_t*, pcu_coll* c);
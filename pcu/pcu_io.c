@@ -18,11 +18,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
 
 #ifdef PCU_BZIP
 #include <bzlib.h>
 #endif
 
+struct pcu_shared;
+
 typedef struct pcu_file {
   FILE* f;
 #ifdef PCU_BZIP
@@ -30,6 +36,7 @@ typedef struct pcu_file {
 #endif
   bool write;
   bool compress;
+  struct pcu_shared* shared; //set by pcu_fopen_shared
 } pcu_file;
 
 #ifdef PCU_BZIP
@@ -187,6 +194,7 @@ pcu_file* pcu_fopen(PCU_t h, const char* name, bool write, bool compress)
   pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
   pf->compress = compress;
   pf->write = write;
+  pf->shared = NULL;
   pf->f = pcu_group_open(h, name, write);
   if (!pf->f) {
     perror("pcu_fopen");
@@ -197,11 +205,15 @@ pcu_file* pcu_fopen(PCU_t h, const char* name, bool write, bool compress)
   return pf;
 }
 
+static void close_shared(struct pcu_shared* s, bool write);
+
 void pcu_fclose(pcu_file* pf)
 {
   if (pf->compress)
     close_compressed(pf);
   fclose(pf->f);
+  if (pf->shared)
+    close_shared(pf->shared, pf->write);
   free(pf);
 }
 
@@ -355,6 +367,91 @@ void pcu_write_string (pcu_file * f, const char * p)
   pcu_write (f, p, len + 1);
 }
 
+/* writes to a growing buffer which, after pcu_fclose,
+   is left in *data (to be freed by the caller) and *size */
+pcu_file* pcu_fmemopen_write(char** data, size_t* size)
+{
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  pf->compress = false;
+  pf->write = true;
+  pf->shared = NULL;
+#ifndef _WIN32
+  pf->f = open_memstream(data, size);
+#else
+  (void)data;
+  (void)size;
+  pf->f = NULL;
+#endif
+  if (!pf->f)
+    reel_fail("pcu_fmemopen_write: open_memstream failed");
+  return pf;
+}
+
+/* reads from the given buffer, which must outlive the file */
+pcu_file* pcu_fmemopen_read(void* data, size_t size)
+{
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  pf->compress = false;
+  pf->write = false;
+  pf->shared = NULL;
+#ifndef _WIN32
+  pf->f = fmemopen(data, size, "r");
+#else
+  (void)data;
+  (void)size;
+  pf->f = NULL;
+#endif
+  if (!pf->f)
+    reel_fail("pcu_fmemopen_read: fmemopen failed");
+  return pf;
+}
+
+/* maps the whole uncompressed file into memory.
+   the mapping is private: writes to it are allowed but
+   are not carried through to the file. */
+static void* map_shared(struct pcu_shared* s, size_t* size);
+
+void* pcu_fmap(pcu_file* f, size_t* size)
+{
+  struct stat st;
+  void* p;
+  if (f->compress || f->write)
+    reel_fail("pcu_fmap: only uncompressed input files can be mapped");
+  if (f->shared)
+    return map_shared(f->shared, size);
+  if (fstat(fileno(f->f), &st))
+    reel_fail("pcu_fmap: fstat failed");
+  *size = st.st_size;
+  if (!*size)
+    return NULL;
+#ifndef _WIN32
+  p = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+      fileno(f->f), 0);
+  if (p == MAP_FAILED)
+    reel_fail("pcu_fmap: mmap of %lu bytes failed", (unsigned long)*size);
+#else
+  long at = ftell(f->f);
+  p = malloc(*size);
+  rewind(f->f);
+  pcu_fread(p, 1, *size, f);
+  fseek(f->f, at, SEEK_SET);
+#endif
+  return p;
+}
+
+void pcu_funmap(pcu_file* f, void* p, size_t size)
+{
+  /* the part of a shared file stays in memory until pcu_fclose */
+  if (!p || f->shared)
+    return;
+#ifndef _WIN32
+  munmap(p, size);
+#else
+  (void)size;
+  free(p);
+#endif
+}
+
 FILE* pcu_open_parallel(PCU_t h, const char* prefix, const char* ext)
 {
   //max_rank_chars = strlen("4294967296"), 4294967296 = 2^32 ~= INT_MAX
@@ -368,3 +465,285 @@ FILE* pcu_open_parallel(PCU_t h, const char* prefix, const char* ext)
   noto_free(path);
   return file;
 }
+
+/* shared files hold the parts of several ranks, so that a mesh
+   written by many ranks makes few files. A shared file is
+     magic, version, n, offset[0], ..., offset[n]
+   as big endian 64-bit words, followed by the parts in rank order,
+   part i taking the bytes from offset[i] to offset[i + 1].
+   Each rank reads and writes its part in memory, and the file is
+   accessed only at open and close, with collective MPI-IO. */
+
+enum {
+  SHARED_MAGIC = 0x70637566, /* "pcuf" */
+  SHARED_VERSION = 1,
+  SHARED_HEADER_WORDS = 3
+};
+
+/* MPI counts are ints, so large parts move in pieces */
+#define SHARED_PIECE ((size_t)1 << 30)
+
+struct pcu_shared {
+  PCU_Comm comm; //the ranks of this file
+  char* path;
+  char* data; //this part
+  size_t size;
+};
+
+static void encode_words(uint64_t* p, size_t n)
+{
+  size_t i;
+  if (PCU_ENDIANNESS != PCU_ENCODED_ENDIAN)
+    for (i = 0; i < n; ++i)
+      pcu_swap_64(p + i);
+}
+
+static void decode_words(uint64_t* p, size_t n)
+{
+  encode_words(p, n);
+}
+
+static void check_header(struct pcu_shared* s, uint64_t* header, int n)
+{
+  decode_words(header, SHARED_HEADER_WORDS);
+  if (header[0] != SHARED_MAGIC || header[1] != SHARED_VERSION)
+    reel_fail("pcu_fopen_shared: \"%s\" is not a shared PCU file", s->path);
+  if (header[2] != (uint64_t)n)
+    reel_fail("pcu_fopen_shared: \"%s\" has %lu parts, opened by %d ranks",
+        s->path, (unsigned long)header[2], n);
+}
+
+static uint64_t* make_index(uint64_t* sizes, int n)
+{
+  uint64_t* index;
+  int i;
+  index = noto_malloc((SHARED_HEADER_WORDS + n + 1) * sizeof(uint64_t));
+  index[0] = SHARED_MAGIC;
+  index[1] = SHARED_VERSION;
+  index[2] = n;
+  index[SHARED_HEADER_WORDS] = (SHARED_HEADER_WORDS + n + 1)
+    * sizeof(uint64_t);
+  for (i = 0; i < n; ++i)
+    index[SHARED_HEADER_WORDS + i + 1] = index[SHARED_HEADER_WORDS + i]
+      + sizes[i];
+  encode_words(index, SHARED_HEADER_WORDS + n + 1);
+  return index;
+}
+
+#ifndef SCOREC_NO_MPI
+
+static MPI_Info make_hints(void)
+{
+  MPI_Info info;
+  MPI_Info_create(&info);
+  /* ask ROMIO to aggregate the parts into large writes */
+  MPI_Info_set(info, "romio_cb_write", "enable");
+  MPI_Info_set(info, "romio_cb_read", "enable");
+  return info;
+}
+
+static MPI_File open_file(struct pcu_shared* s, int mode)
+{
+  MPI_File fh;
+  MPI_Info info = make_hints();
+  if (MPI_File_open(s->comm, s->path, mode, info, &fh) != MPI_SUCCESS)
+    reel_fail("pcu_fopen_shared couldn't open \"%s\"", s->path);
+  MPI_Info_free(&info);
+  return fh;
+}
+
+/* every rank takes part in as many collective calls
+   as the rank with the largest part needs */
+static void move_all(struct pcu_shared* s, MPI_File fh, uint64_t offset,
+    char* p, size_t size, bool write)
+{
+  uint64_t pieces = (size + SHARED_PIECE - 1) / SHARED_PIECE;
+  uint64_t most;
+  uint64_t i;
+  size_t n;
+  int err;
+  MPI_Allreduce(&pieces, &most, 1, MPI_UINT64_T, MPI_MAX, s->comm);
+  for (i = 0; i < most; ++i) {
+    n = size < SHARED_PIECE ? size : SHARED_PIECE;
+    if (write)
+      err = MPI_File_write_at_all(fh, (MPI_Offset)offset, p, (int)n,
+          MPI_BYTE, MPI_STATUS_IGNORE);
+    else
+      err = MPI_File_read_at_all(fh, (MPI_Offset)offset, p, (int)n,
+          MPI_BYTE, MPI_STATUS_IGNORE);
+    if (err != MPI_SUCCESS)
+      reel_fail("pcu shared file \"%s\": collective %s failed", s->path,
+          write ? "write" : "read");
+    offset += n;
+    p += n;
+    size -= n;
+  }
+}
+
+static void split_shared(PCU_t h, struct pcu_shared* s, int file)
+{
+  MPI_Comm dup;
+  PCU_Comm_Dup(h, &dup);
+  MPI_Comm_split(dup, file, PCU_Comm_Self(h), &s->comm);
+  MPI_Comm_free(&dup);
+}
+
+static void write_shared(struct pcu_shared* s)
+{
+  uint64_t size = s->size;
+  uint64_t offset = 0;
+  uint64_t* sizes = NULL;
+  uint64_t* index = NULL;
+  uint64_t first;
+  MPI_File fh;
+  int rank, n;
+  MPI_Comm_rank(s->comm, &rank);
+  MPI_Comm_size(s->comm, &n);
+  if (!rank)
+    sizes = noto_malloc(n * sizeof(uint64_t));
+  MPI_Gather(&size, 1, MPI_UINT64_T, sizes, 1, MPI_UINT64_T, 0, s->comm);
+  MPI_Exscan(&size, &offset, 1, MPI_UINT64_T, MPI_SUM, s->comm);
+  if (!rank)
+    offset = 0;
+  fh = open_file(s, MPI_MODE_CREATE | MPI_MODE_WRONLY);
+  MPI_File_set_size(fh, 0);
+  if (!rank) {
+    index = make_index(sizes, n);
+    if (MPI_File_write_at(fh, 0, index,
+          (SHARED_HEADER_WORDS + n + 1) * sizeof(uint64_t), MPI_BYTE,
+          MPI_STATUS_IGNORE) != MPI_SUCCESS)
+      reel_fail("pcu shared file \"%s\": index write failed", s->path);
+    noto_free(index);
+    noto_free(sizes);
+  }
+  first = (SHARED_HEADER_WORDS + n + 1) * sizeof(uint64_t);
+  move_all(s, fh, first + offset, s->data, s->size, true);
+  MPI_File_close(&fh);
+}
+
+static void read_shared(struct pcu_shared* s)
+{
+  uint64_t header[SHARED_HEADER_WORDS];
+  uint64_t range[2];
+  MPI_File fh;
+  int rank, n;
+  MPI_Comm_rank(s->comm, &rank);
+  MPI_Comm_size(s->comm, &n);
+  fh = open_file(s, MPI_MODE_RDONLY);
+  move_all(s, fh, 0, (char*)header, sizeof(header), false);
+  check_header(s, header, n);
+  move_all(s, fh, (SHARED_HEADER_WORDS + rank) * sizeof(uint64_t),
+      (char*)range, sizeof(range), false);
+  decode_words(range, 2);
+  s->size = range[1] - range[0];
+  s->data = malloc(s->size ? s->size : 1);
+  move_all(s, fh, range[0], s->data, s->size, false);
+  MPI_File_close(&fh);
+}
+
+static void free_comm(struct pcu_shared* s)
+{
+  MPI_Comm_free(&s->comm);
+}
+
+#else
+
+/* without MPI the one rank has the file to itself */
+
+static void split_shared(PCU_t h, struct pcu_shared* s, int file)
+{
+  (void)h;
+  (void)file;
+  s->comm = 0;
+}
+
+static void write_shared(struct pcu_shared* s)
+{
+  uint64_t size = s->size;
+  uint64_t* index = make_index(&size, 1);
+  FILE* f = fopen(s->path, "wb");
+  if (!f)
+    reel_fail("pcu_fopen_shared couldn't open \"%s\"", s->path);
+  if (fwrite(index, sizeof(uint64_t), SHARED_HEADER_WORDS + 2, f)
+      != SHARED_HEADER_WORDS + 2 || fwrite(s->data, 1, s->size, f) != s->size)
+    reel_fail("pcu shared file \"%s\": write failed", s->path);
+  fclose(f);
+  noto_free(index);
+}
+
+static void read_shared(struct pcu_shared* s)
+{
+  uint64_t header[SHARED_HEADER_WORDS];
+  uint64_t range[2];
+  FILE* f = fopen(s->path, "rb");
+  if (!f)
+    reel_fail("pcu_fopen_shared couldn't open \"%s\"", s->path);
+  if (fread(header, sizeof(header), 1, f) != 1)
+    reel_fail("pcu shared file \"%s\": read failed", s->path);
+  check_header(s, header, 1);
+  if (fread(range, sizeof(range), 1, f) != 1)
+    reel_fail("pcu shared file \"%s\": read failed", s->path);
+  decode_words(range, 2);
+  s->size = range[1] - range[0];
+  s->data = malloc(s->size ? s->size : 1);
+  if (fseek(f, (long)range[0], SEEK_SET)
+      || fread(s->data, 1, s->size, f) != s->size)
+    reel_fail("pcu shared file \"%s\": read failed", s->path);
+  fclose(f);
+}
+
+static void free_comm(struct pcu_shared* s)
+{
+  (void)s;
+}
+
+#endif
+
+/* collective over h. ranks that pass the same file index share the
+   file at path, where their parts are kept in rank order. Reading
+   needs as many ranks per file as there were when it was written. */
+pcu_file* pcu_fopen_shared(PCU_t h, const char* path, int file,
+    bool write, bool compress)
+{
+  pcu_file* pf = (pcu_file*) malloc(sizeof(pcu_file));
+  struct pcu_shared* s = (struct pcu_shared*) malloc(sizeof(*s));
+  pf->compress = compress;
+  pf->write = write;
+  pf->shared = s;
+  s->path = malloc(strlen(path) + 1);
+  strcpy(s->path, path);
+  s->data = NULL;
+  s->size = 0;
+  split_shared(h, s, file);
+#ifndef _WIN32
+  if (write) {
+    pf->f = open_memstream(&s->data, &s->size);
+  } else {
+    read_shared(s);
+    pf->f = fmemopen(s->data, s->size, "r");
+  }
+#else
+  pf->f = NULL;
+#endif
+  if (!pf->f)
+    reel_fail("pcu_fopen_shared couldn't open \"%s\" in memory", path);
+  if (compress)
+    open_compressed(pf);
+  return pf;
+}
+
+static void close_shared(struct pcu_shared* s, bool write)
+{
+  if (write)
+    write_shared(s);
+  free_comm(s);
+  free(s->data);
+  free(s->path);
+  free(s);
+}
+
+static void* map_shared(struct pcu_shared* s, size_t* size)
+{
+  *size = s->size;
+  return s->size ? s->data : NULL;
+}
@@ -34,6 +34,12 @@ void pcu_read_doubles(struct pcu_file* f, double* p, size_t n);
 void pcu_write_doubles(struct pcu_file* f, double* p, size_t n);
 void pcu_read_string(struct pcu_file* f, char** p);
 void pcu_write_string(struct pcu_file* f, const char* p);
+struct pcu_file* pcu_fmemopen_write(char** data, size_t* size);
+struct pcu_file* pcu_fmemopen_read(void* data, size_t size);
+void* pcu_fmap(struct pcu_file* f, size_t* size);
+void pcu_funmap(struct pcu_file* f, void* p, size_t size);
+struct pcu_file* pcu_fopen_shared(PCU_t h, const char* path, int file,
+    bool write, bool compress);
 
 FILE* pcu_open_parallel(PCU_t h, const char* prefix, const char* ext);
 FILE* pcu_group_open(PCU_t h, const char* path, bool write);
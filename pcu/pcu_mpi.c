@@ -14,6 +14,7 @@
 void pcu_make_message(pcu_message* m)
 {
   pcu_make_buffer(&(m->buffer));
+  m->shm_pending = 0;
 }
 
 void pcu_free_message(pcu_message* m)
@@ -56,6 +57,22 @@ bool pcu_mpi_receive(const pcu_mpi_t* self, pcu_message* m, PCU_Comm comm)
     check_rank(self, m->peer);
   return pcu_pmpi_receive(self, m, comm);
 }
+void pcu_mpi_send2(const pcu_mpi_t* self, pcu_message* m, int tag,
+    PCU_Comm comm)
+{
+  check_rank(self, m->peer);
+  PCU_ALWAYS_ASSERT(comm == self->user_comm || comm == self->coll_comm);
+  pcu_pmpi_send2(self, m, tag, comm);
+}
+
+bool pcu_mpi_receive2(const pcu_mpi_t* self, pcu_message* m, int tag,
+    PCU_Comm comm)
+{
+  if (m->peer != PCU_ANY_SOURCE)
+    check_rank(self, m->peer);
+  return pcu_pmpi_receive2(self, m, tag, comm);
+}
+
 void pcu_mpi_init(PCU_Comm comm, pcu_mpi_t* mpi) {
   pcu_pmpi_init(comm, mpi);
 }
@@ -71,3 +88,53 @@ int pcu_mpi_split(const pcu_mpi_t* mpi, int color, int key,
 int pcu_mpi_dup(const pcu_mpi_t* mpi, PCU_Comm* newcomm) {
   return pcu_pmpi_dup(mpi, newcomm);
 }
+
+void pcu_mpi_allreduce(const pcu_mpi_t* mpi, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op)
+{
+  pcu_pmpi_allreduce(mpi, data, n, type, op);
+}
+
+void pcu_mpi_exscan(const pcu_mpi_t* mpi, void* data, size_t n,
+    enum pcu_mpi_type type)
+{
+  pcu_pmpi_exscan(mpi, data, n, type);
+}
+
+void pcu_mpi_allgather(const pcu_mpi_t* mpi, const void* send, void* recv,
+    size_t n, enum pcu_mpi_type type)
+{
+  pcu_pmpi_allgather(mpi, send, recv, n, type);
+}
+
+void pcu_mpi_iallreduce(const pcu_mpi_t* mpi, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op, PCU_Request* r)
+{
+  pcu_pmpi_iallreduce(mpi, data, n, type, op, r);
+}
+
+void pcu_mpi_iexscan(const pcu_mpi_t* mpi, void* data, size_t n,
+    enum pcu_mpi_type type, PCU_Request* r)
+{
+  pcu_pmpi_iexscan(mpi, data, n, type, r);
+}
+
+bool pcu_mpi_test(const pcu_mpi_t* mpi, PCU_Request* r)
+{
+  return pcu_pmpi_test(mpi, r);
+}
+
+void pcu_mpi_shared(pcu_mpi_t* mpi, size_t capacity)
+{
+  pcu_pmpi_shared(mpi, capacity);
+}
+
+double pcu_mpi_time(void)
+{
+  return pcu_pmpi_time();
+}
+
+void pcu_mpi_set_nodes(pcu_mpi_t* mpi, bool on, int node_size)
+{
+  pcu_pmpi_set_nodes(mpi, on, node_size);
+}
@@ -22,29 +22,78 @@ typedef struct
   pcu_buffer buffer;
   PCU_Request request;
   int peer;
+  int shm_pending; //sent through shared memory and not yet taken
 } pcu_message;
 
 void pcu_make_message(pcu_message* m);
 void pcu_free_message(pcu_message* m);
 
+struct pcu_shm;
+
+/* the ranks grouped by node, for the hierarchical mode */
+typedef struct
+{
+  PCU_Comm node_comm; //the ranks of this node
+  PCU_Comm leader_comm; //the first rank of each node, null elsewhere
+  int nodes; //number of nodes
+  int* node; //node of each rank
+  int* local; //index of each rank among those of its node
+  int* node_begin; //where the ranks of each node start in node_ranks
+  int* node_ranks; //the ranks of every node, in order
+} pcu_mpi_nodes;
+
 struct pcu_mpi_struct
 {
   PCU_Comm user_comm;
   PCU_Comm coll_comm;
   int rank;
   int size;
+  int native_coll; //use the MPI collectives for built-in types
+  struct pcu_shm* shm; //on-node transport, if enabled
+  pcu_mpi_nodes* nodes; //the node hierarchy, if enabled
 };
 typedef struct pcu_mpi_struct pcu_mpi_t;
 
+/* the built-in types and operations
+   of the native collectives */
+enum pcu_mpi_type {
+  PCU_MPI_INT,
+  PCU_MPI_LONG,
+  PCU_MPI_SIZE_T,
+  PCU_MPI_DOUBLE
+};
+enum pcu_mpi_op {
+  PCU_MPI_SUM,
+  PCU_MPI_MIN,
+  PCU_MPI_MAX
+};
+
 int pcu_mpi_size(const pcu_mpi_t*);
 int pcu_mpi_rank(const pcu_mpi_t*);
 void pcu_mpi_send(const pcu_mpi_t*, pcu_message* m, PCU_Comm comm);
 bool pcu_mpi_done(const pcu_mpi_t*, pcu_message* m);
 bool pcu_mpi_receive(const pcu_mpi_t*, pcu_message* m, PCU_Comm comm);
+void pcu_mpi_send2(const pcu_mpi_t*, pcu_message* m, int tag, PCU_Comm comm);
+bool pcu_mpi_receive2(const pcu_mpi_t*, pcu_message* m, int tag,
+    PCU_Comm comm);
 void pcu_mpi_init(PCU_Comm comm, pcu_mpi_t* mpi);
 void pcu_mpi_finalize(pcu_mpi_t* mpi);
 int  pcu_mpi_split(const pcu_mpi_t* mpi, int color, int key, PCU_Comm* newcomm);
 int  pcu_mpi_dup(const pcu_mpi_t* mpi, PCU_Comm* newcomm);
+void pcu_mpi_allreduce(const pcu_mpi_t*, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op);
+void pcu_mpi_exscan(const pcu_mpi_t*, void* data, size_t n,
+    enum pcu_mpi_type type);
+void pcu_mpi_allgather(const pcu_mpi_t*, const void* send, void* recv,
+    size_t n, enum pcu_mpi_type type);
+void pcu_mpi_iallreduce(const pcu_mpi_t*, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op, PCU_Request* r);
+void pcu_mpi_iexscan(const pcu_mpi_t*, void* data, size_t n,
+    enum pcu_mpi_type type, PCU_Request* r);
+bool pcu_mpi_test(const pcu_mpi_t*, PCU_Request* r);
+void pcu_mpi_shared(pcu_mpi_t*, size_t capacity);
+double pcu_mpi_time(void);
+void pcu_mpi_set_nodes(pcu_mpi_t*, bool on, int node_size);
 
 #ifdef __cplusplus
 }
@@ -10,6 +10,7 @@
 #include "pcu_msg.h"
 #include "noto_malloc.h"
 #include "reel.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* the pcu_msg algorithm for a communication phase
@@ -49,8 +50,20 @@
    If another rank is notified first and quickly goes on to
    a new phase, it may be able to send a message that is
    received by the slow rank out-of-phase.
+
+   In the neighborhood mode, each rank sends exactly one
+   (possibly empty) message to each of its neighbors per phase
+   and the phase ends once one message came from each neighbor
+   and all sends are done. This requires the neighbor sets to
+   be symmetric. Since messages between two ranks with the
+   same tag are not overtaking, the k-th message received from
+   a neighbor belongs to the k-th phase, so neither barrier is
+   needed. A separate tag keeps these messages apart from
+   those of the global mode.
 */
 
+enum { neighbor_tag = 1 };
+
 //enumeration for pcu_msg.state
 enum {
   idle_state, //in between phases
@@ -64,6 +77,11 @@ static void make_comm(pcu_msg* m)
   pcu_make_aa(&(m->peers));
   pcu_make_message(&(m->received));
   m->state = idle_state;
+  m->last_peer = NULL;
+  m->flushed = NULL;
+  m->counting = false;
+  m->packed = false;
+  m->routed_phase = false;
 }
 
 void pcu_make_msg(pcu_msg* m)
@@ -71,6 +89,81 @@ void pcu_make_msg(pcu_msg* m)
   make_comm(m);
   m->file = NULL;
   m->order = NULL;
+  m->prof = NULL;
+  m->nbors = NULL;
+  m->nbor_count = 0;
+  m->outbox = NULL;
+  m->waiting = NULL;
+  m->waiting_count = 0;
+  m->nbor_index = NULL;
+  m->icoll_tag = 0;
+  m->arena = NULL;
+  m->arena_size = 0;
+  pcu_make_buffer(&(m->routed));
+  m->routed_at = 0;
+}
+
+static void free_neighbors(pcu_msg* m)
+{
+  int i;
+  for (i = 0; i < m->nbor_count; ++i)
+    pcu_free_message(&(m->outbox[i]));
+  noto_free(m->nbors);
+  noto_free(m->outbox);
+  noto_free(m->waiting);
+  noto_free(m->nbor_index);
+  m->nbors = NULL;
+  m->nbor_count = 0;
+  m->outbox = NULL;
+  m->waiting = NULL;
+  m->nbor_index = NULL;
+}
+
+static int compare_ints(const void* a, const void* b)
+{
+  return *(const int*)a - *(const int*)b;
+}
+
+void pcu_msg_set_neighbors(pcu_mpi_t* mpi, pcu_msg* m,
+    const int* peers, int n)
+{
+  int i;
+  if (m->state != idle_state)
+    reel_fail("PCU neighbors set in the middle of a phase");
+  free_neighbors(m);
+  if (!peers)
+    return;
+  NOTO_MALLOC(m->nbors, n + 1);
+  for (i = 0; i < n; ++i) {
+    if (peers[i] < 0 || peers[i] >= pcu_mpi_size(mpi))
+      reel_fail("Invalid rank %d in PCU neighbors", peers[i]);
+    m->nbors[i] = peers[i];
+  }
+  /* always include this rank, packing to oneself is common */
+  m->nbors[n] = pcu_mpi_rank(mpi);
+  qsort(m->nbors, n + 1, sizeof(int), compare_ints);
+  m->nbor_count = 0;
+  for (i = 0; i < n + 1; ++i)
+    if (!i || m->nbors[i] != m->nbors[i - 1])
+      m->nbors[m->nbor_count++] = m->nbors[i];
+  NOTO_MALLOC(m->outbox, m->nbor_count);
+  NOTO_MALLOC(m->waiting, m->nbor_count);
+  NOTO_MALLOC(m->nbor_index, pcu_mpi_size(mpi));
+  for (i = 0; i < pcu_mpi_size(mpi); ++i)
+    m->nbor_index[i] = -1;
+  for (i = 0; i < m->nbor_count; ++i) {
+    pcu_make_message(&(m->outbox[i]));
+    m->outbox[i].peer = m->nbors[i];
+    m->nbor_index[m->nbors[i]] = i;
+  }
+}
+
+static pcu_message* find_neighbor(pcu_msg* m, int id)
+{
+  int i = m->nbor_index[id];
+  if (i < 0)
+    reel_fail("PCU_Comm_Pack to rank %d, which is not a neighbor", id);
+  return &(m->outbox[i]);
 }
 
 static void free_peers(pcu_aa_tree* t)
@@ -81,19 +174,33 @@ static void free_peers(pcu_aa_tree* t)
   free_peers(&((*t)->right));
   pcu_msg_peer* peer;
   peer = (pcu_msg_peer*) *t;
-  pcu_free_message(&(peer->message));
+  if (!peer->in_arena)
+    pcu_free_message(&(peer->message));
   noto_free(peer);
   pcu_make_aa(t);
 }
 
 void pcu_msg_start(pcu_mpi_t* mpi, pcu_msg* m)
 {
+  int i;
   if (m->state != idle_state)
     reel_fail("PCU_Comm_Begin called at the wrong time");
+  if (m->prof) {
+    memset(&(m->counts), 0, sizeof(m->counts));
+    m->counts.begin = pcu_mpi_time();
+  }
+  if (m->nbors) {
+    for (i = 0; i < m->nbor_count; ++i)
+      pcu_begin_buffer(&(m->outbox[i].buffer));
+    m->state = pack_state;
+    return;
+  }
   /* this barrier ensures no one starts a new superstep
      while others are receiving in the past superstep.
      It is the only blocking call in the pcu_msg system. */
   pcu_barrier(mpi, &(m->coll));
+  if (m->prof)
+    m->counts.wait += pcu_mpi_time() - m->counts.begin;
   m->state = pack_state;
 }
 
@@ -116,49 +223,191 @@ static pcu_msg_peer* make_peer(int id)
   NOTO_MALLOC(p,1);
   pcu_make_message(&(p->message));
   p->message.peer = id;
+  p->counted = 0;
+  p->in_arena = false;
   return p;
 }
 
-void* pcu_msg_pack(pcu_msg* m, int id, size_t size)
+/* packing tends to go to the same peer many times in a row,
+   so that one is looked up without the tree */
+static pcu_msg_peer* get_peer(pcu_msg* m, int id)
 {
-  if (m->state != pack_state)
-    reel_fail("PCU_Comm_Pack called at the wrong time");
-  pcu_msg_peer* peer = find_peer(m->peers,id);
+  pcu_msg_peer* peer = m->last_peer;
+  if (peer && peer->message.peer == id)
+    return peer;
+  peer = find_peer(m->peers,id);
   if (!peer)
   {
     peer = make_peer(id);
     pcu_aa_insert(&(peer->node),&(m->peers),peer_less);
   }
-  return pcu_push_buffer(&(peer->message.buffer),size);
+  m->last_peer = peer;
+  return peer;
+}
+
+/* counted send buffers are aligned slices of the arena */
+static size_t slice_size(size_t bytes)
+{
+  return (bytes + 15) & ~((size_t)15);
+}
+
+static size_t count_arena(pcu_aa_tree t)
+{
+  if (pcu_aa_empty(t))
+    return 0;
+  return slice_size(((pcu_msg_peer*)t)->counted)
+    + count_arena(t->left) + count_arena(t->right);
+}
+
+static void cut_arena(pcu_aa_tree t, char** at)
+{
+  pcu_msg_peer* peer;
+  if (pcu_aa_empty(t))
+    return;
+  peer = (pcu_msg_peer*)t;
+  if (peer->counted) {
+    pcu_set_buffer(&(peer->message.buffer), *at, peer->counted);
+    pcu_begin_buffer(&(peer->message.buffer));
+    peer->in_arena = true;
+    *at += slice_size(peer->counted);
+  }
+  cut_arena(t->left, at);
+  cut_arena(t->right, at);
+}
+
+static void allocate_arena(pcu_msg* m)
+{
+  char* at;
+  size_t size = count_arena(m->peers);
+  if (size > m->arena_size) {
+    noto_free(m->arena);
+    m->arena = noto_malloc(size);
+    m->arena_size = size;
+  }
+  at = m->arena;
+  cut_arena(m->peers, &at);
+  m->counting = false;
+}
+
+void pcu_msg_count(pcu_msg* m, int id, size_t size)
+{
+  if (m->state != pack_state)
+    reel_fail("PCU_Comm_Count called at the wrong time");
+  if (m->packed)
+    reel_fail("PCU_Comm_Count called after packing");
+  /* neighbor buffers are kept between phases, so they
+     rarely grow and need no counts */
+  if (m->nbors)
+    return;
+  get_peer(m, id)->counted += size;
+  m->counting = true;
+}
+
+/* a counted buffer that overflows moves out of the arena */
+static void* push_peer(pcu_msg_peer* peer, size_t size)
+{
+  pcu_buffer* b = &(peer->message.buffer);
+  if (peer->in_arena && b->size + size > b->capacity) {
+    char* old = b->start;
+    size_t used = b->size;
+    pcu_make_buffer(b);
+    memcpy(pcu_push_buffer(b, used), old, used);
+    peer->in_arena = false;
+  }
+  return pcu_push_buffer(b, size);
+}
+
+void* pcu_msg_pack(pcu_msg* m, int id, size_t size)
+{
+  if (m->state != pack_state)
+    reel_fail("PCU_Comm_Pack called at the wrong time");
+  m->packed = true;
+  if (m->nbors)
+    return pcu_push_buffer(&(find_neighbor(m, id)->buffer), size);
+  if (m->counting)
+    allocate_arena(m);
+  return push_peer(get_peer(m, id), size);
 }
 
 size_t pcu_msg_packed(pcu_msg* m, int id)
 {
   if (m->state != pack_state)
     reel_fail("PCU_Comm_Packed called at the wrong time");
+  if (m->nbors)
+    return find_neighbor(m, id)->buffer.size;
   pcu_msg_peer* peer = find_peer(m->peers,id);
-  if (!peer)
+  if (!peer || !peer->message.buffer.start)
     reel_fail("PCU_Comm_Packed called but nothing was packed");
   return peer->message.buffer.size;
 }
 
-static void send_peers(pcu_mpi_t* mpi, pcu_aa_tree t)
+static void count_sent(pcu_msg_counts* c, pcu_message* message)
 {
-  if (pcu_aa_empty(t))
+  if (!message->buffer.size)
     return;
-  pcu_msg_peer* peer;
-  peer = (pcu_msg_peer*)t;
-  pcu_mpi_send(mpi, &(peer->message),mpi->user_comm);
-  send_peers(mpi, t->left);
-  send_peers(mpi, t->right);
+  c->sent_bytes += message->buffer.size;
+  ++c->sent_messages;
 }
 
-void pcu_msg_send(pcu_mpi_t* mpi, pcu_msg* m)
+/* sends what was packed for a peer so far as a message of its
+   own, so that it travels while this rank keeps packing. The
+   receiver then gets several messages from this rank, which only
+   the global mode without ordering allows; the other modes keep
+   everything in one buffer. */
+void pcu_msg_flush(pcu_mpi_t* mpi, pcu_msg* m, int id)
 {
+  pcu_msg_peer* peer;
+  pcu_msg_flushed* f;
   if (m->state != pack_state)
-    reel_fail("PCU_Comm_Send called at the wrong time");
-  send_peers(mpi, m->peers);
-  m->state = send_recv_state;
+    reel_fail("PCU_Comm_Flush called at the wrong time");
+  if (m->nbors || m->order || mpi->nodes)
+    return;
+  peer = find_peer(m->peers, id);
+  if (!peer || !peer->message.buffer.size)
+    return;
+  NOTO_MALLOC(f, 1);
+  f->message = peer->message;
+  f->in_arena = peer->in_arena;
+  f->next = m->flushed;
+  m->flushed = f;
+  pcu_make_buffer(&(peer->message.buffer));
+  peer->in_arena = false;
+  if (m->prof)
+    count_sent(&(m->counts), &(f->message));
+  pcu_mpi_send(mpi, &(f->message), mpi->user_comm);
+}
+
+static bool done_flushing(pcu_mpi_t* mpi, pcu_msg* m)
+{
+  pcu_msg_flushed* f;
+  for (f = m->flushed; f; f = f->next)
+    if (!pcu_mpi_done(mpi, &(f->message)))
+      return false;
+  return true;
+}
+
+static void free_flushed(pcu_msg* m)
+{
+  pcu_msg_flushed* f;
+  while ((f = m->flushed)) {
+    m->flushed = f->next;
+    if (!f->in_arena)
+      pcu_free_message(&(f->message));
+    noto_free(f);
+  }
+}
+
+static void send_peers(pcu_mpi_t* mpi, pcu_aa_tree t, int tag)
+{
+  if (pcu_aa_empty(t))
+    return;
+  pcu_msg_peer* peer;
+  peer = (pcu_msg_peer*)t;
+  /* a peer may be counted for and then not packed for */
+  if (peer->message.buffer.size)
+    pcu_mpi_send2(mpi, &(peer->message), tag, mpi->user_comm);
+  send_peers(mpi, t->left, tag);
+  send_peers(mpi, t->right, tag);
 }
 
 static bool done_sending_peers(pcu_mpi_t* mpi, pcu_aa_tree t)
@@ -167,19 +416,225 @@ static bool done_sending_peers(pcu_mpi_t* mpi, pcu_aa_tree t)
     return true;
   pcu_msg_peer* peer;
   peer = (pcu_msg_peer*)t;
-  return pcu_mpi_done(mpi, &(peer->message))
+  return (!peer->message.buffer.size
+      || pcu_mpi_done(mpi, &(peer->message)))
     && done_sending_peers(mpi, t->left)
     && done_sending_peers(mpi, t->right);
 }
 
+/* the hierarchical mode, used while mpi->nodes is set:
+   a message to another node goes first to the rank of its
+   source node that gathers everything for the destination
+   node, then to a rank of the destination node in one
+   message per pair of nodes, and finally to its destination.
+   Each of the three rounds ends with a barrier, and the
+   messages for this rank are kept in m->routed until
+   pcu_msg_receive hands them out. */
+
+enum { route_tag = 2, route_rounds = 3 };
+
+typedef struct
+{
+  int source;
+  int dest;
+  size_t size;
+} pcu_route_header;
+
+static int next_hop(pcu_mpi_nodes* n, int self, int dest)
+{
+  int here = n->node[self];
+  int there = n->node[dest];
+  int proxy;
+  int* ranks;
+  if (here == there)
+    return dest;
+  ranks = n->node_ranks + n->node_begin[here];
+  proxy = ranks[there % (n->node_begin[here + 1] - n->node_begin[here])];
+  if (proxy != self)
+    return proxy;
+  ranks = n->node_ranks + n->node_begin[there];
+  return ranks[n->local[self] % (n->node_begin[there + 1]
+        - n->node_begin[there])];
+}
+
+static void push_record(pcu_buffer* b, pcu_route_header* h,
+    const void* data)
+{
+  memcpy(pcu_push_buffer(b, sizeof(*h)), h, sizeof(*h));
+  if (h->size)
+    memcpy(pcu_push_buffer(b, h->size), data, h->size);
+}
+
+/* files a record under the rank it goes to next,
+   or keeps it if it has arrived */
+static void route_record(pcu_mpi_t* mpi, pcu_msg* m, pcu_aa_tree* bundles,
+    pcu_route_header* h, const void* data)
+{
+  int self = pcu_mpi_rank(mpi);
+  int to;
+  pcu_msg_peer* bundle;
+  if (h->dest == self) {
+    push_record(&(m->routed), h, data);
+    return;
+  }
+  to = next_hop(mpi->nodes, self, h->dest);
+  bundle = find_peer(*bundles, to);
+  if (!bundle) {
+    bundle = make_peer(to);
+    pcu_aa_insert(&(bundle->node), bundles, peer_less);
+  }
+  push_record(&(bundle->message.buffer), h, data);
+}
+
+static void route_peers(pcu_mpi_t* mpi, pcu_msg* m, pcu_aa_tree* bundles,
+    pcu_aa_tree t)
+{
+  pcu_msg_peer* peer;
+  pcu_route_header h;
+  if (pcu_aa_empty(t))
+    return;
+  peer = (pcu_msg_peer*)t;
+  if (peer->message.buffer.size) {
+    h.source = pcu_mpi_rank(mpi);
+    h.dest = peer->message.peer;
+    h.size = peer->message.buffer.size;
+    route_record(mpi, m, bundles, &h, peer->message.buffer.start);
+  }
+  route_peers(mpi, m, bundles, t->left);
+  route_peers(mpi, m, bundles, t->right);
+}
+
+static void route_buffer(pcu_mpi_t* mpi, pcu_msg* m, pcu_aa_tree* bundles,
+    pcu_buffer* b)
+{
+  pcu_route_header h;
+  char* at = b->start;
+  char* end = b->start + b->size;
+  while (at < end) {
+    memcpy(&h, at, sizeof(h));
+    at += sizeof(h);
+    route_record(mpi, m, bundles, &h, at);
+    at += h.size;
+  }
+}
+
+/* sends the bundles and gathers the ones sent here,
+   then waits for every rank to finish the round */
+static void exchange_bundles(pcu_mpi_t* mpi, pcu_msg* m, pcu_aa_tree* bundles,
+    pcu_buffer* in)
+{
+  pcu_message incoming;
+  bool waiting = false;
+  double begin;
+  pcu_make_message(&incoming);
+  send_peers(mpi, *bundles, route_tag);
+  for (;;) {
+    incoming.peer = PCU_ANY_SOURCE;
+    if (pcu_mpi_receive2(mpi, &incoming, route_tag, mpi->user_comm)) {
+      memcpy(pcu_push_buffer(in, incoming.buffer.size),
+          incoming.buffer.start, incoming.buffer.size);
+      continue;
+    }
+    if (!waiting && done_sending_peers(mpi, *bundles)) {
+      begin = pcu_mpi_time();
+      pcu_begin_barrier(mpi, &(m->coll));
+      waiting = true;
+    }
+    if (waiting && pcu_barrier_done(mpi, &(m->coll)))
+      break;
+  }
+  if (m->prof)
+    m->counts.wait += pcu_mpi_time() - begin;
+  pcu_free_message(&incoming);
+  free_peers(bundles);
+}
+
+static void send_routed(pcu_mpi_t* mpi, pcu_msg* m)
+{
+  pcu_aa_tree bundles;
+  pcu_buffer in;
+  int round;
+  pcu_make_aa(&bundles);
+  m->routed.size = 0;
+  m->routed_at = 0;
+  route_peers(mpi, m, &bundles, m->peers);
+  for (round = 0; round < route_rounds; ++round) {
+    pcu_make_buffer(&in);
+    exchange_bundles(mpi, m, &bundles, &in);
+    route_buffer(mpi, m, &bundles, &in);
+    pcu_free_buffer(&in);
+  }
+  if (!pcu_aa_empty(bundles))
+    reel_fail("PCU routed messages still in transit after %d rounds",
+        route_rounds);
+}
+
+static bool receive_routed(pcu_msg* m)
+{
+  pcu_route_header h;
+  if (m->routed_at == m->routed.size)
+    return false;
+  memcpy(&h, m->routed.start + m->routed_at, sizeof(h));
+  m->routed_at += sizeof(h);
+  pcu_resize_buffer(&(m->received.buffer), h.size);
+  memcpy(m->received.buffer.start, m->routed.start + m->routed_at, h.size);
+  m->routed_at += h.size;
+  m->received.peer = h.source;
+  return true;
+}
+
+
+static void count_peers(pcu_msg_counts* c, pcu_aa_tree t)
+{
+  if (pcu_aa_empty(t))
+    return;
+  count_sent(c, &(((pcu_msg_peer*)t)->message));
+  count_peers(c, t->left);
+  count_peers(c, t->right);
+}
+
+void pcu_msg_send(pcu_mpi_t* mpi, pcu_msg* m)
+{
+  int i;
+  if (m->state != pack_state)
+    reel_fail("PCU_Comm_Send called at the wrong time");
+  if (m->counting)
+    allocate_arena(m);
+  if (m->prof) {
+    if (m->nbors)
+      for (i = 0; i < m->nbor_count; ++i)
+        count_sent(&(m->counts), &(m->outbox[i]));
+    else
+      count_peers(&(m->counts), m->peers);
+  }
+  if (m->nbors) {
+    for (i = 0; i < m->nbor_count; ++i) {
+      pcu_mpi_send2(mpi, &(m->outbox[i]), neighbor_tag, mpi->user_comm);
+      m->waiting[i] = i;
+    }
+    m->waiting_count = m->nbor_count;
+    m->state = send_recv_state;
+    return;
+  }
+  m->state = send_recv_state;
+  if (mpi->nodes) {
+    m->routed_phase = true;
+    send_routed(mpi, m);
+    return;
+  }
+  send_peers(mpi, m->peers, 0);
+}
+
 static bool receive_global(pcu_mpi_t* mpi, pcu_msg* m)
 {
   m->received.peer = PCU_ANY_SOURCE;
   while ( ! pcu_mpi_receive(mpi, &(m->received),mpi->user_comm))
   {
     if (m->state == send_recv_state)
-      if (done_sending_peers(mpi, m->peers))
+      if (done_sending_peers(mpi, m->peers) && done_flushing(mpi, m))
       {
+        if (m->prof)
+          m->counts.wait_begin = pcu_mpi_time();
         pcu_begin_barrier(mpi, &(m->coll));
         m->state = recv_state;
       }
@@ -190,12 +645,65 @@ static bool receive_global(pcu_mpi_t* mpi, pcu_msg* m)
   return true;
 }
 
+static bool done_sending_neighbors(pcu_mpi_t* mpi, pcu_msg* m)
+{
+  int i;
+  for (i = 0; i < m->nbor_count; ++i)
+    if (!pcu_mpi_done(mpi, &(m->outbox[i])))
+      return false;
+  return true;
+}
+
+/* polls the neighbors not yet heard from, dropping each one
+   once its message arrives. Empty messages are not returned,
+   they only mean that nothing was packed for this rank. */
+static bool receive_neighbors(pcu_mpi_t* mpi, pcu_msg* m)
+{
+  int i;
+  while (m->waiting_count) {
+    for (i = 0; i < m->waiting_count; ++i) {
+      m->received.peer = m->nbors[m->waiting[i]];
+      if (pcu_mpi_receive2(mpi, &(m->received), neighbor_tag,
+            mpi->user_comm)) {
+        m->waiting[i] = m->waiting[--m->waiting_count];
+        if (m->received.buffer.size)
+          return true;
+        --i;
+      }
+    }
+  }
+  if (m->prof)
+    m->counts.wait_begin = pcu_mpi_time();
+  while (!done_sending_neighbors(mpi, m));
+  return false;
+}
+
 static void free_comm(pcu_msg* m)
 {
   free_peers(&(m->peers));
+  free_flushed(m);
   pcu_free_message(&(m->received));
 }
 
+static void received(pcu_msg* m)
+{
+  pcu_begin_buffer(&(m->received.buffer));
+  if (!m->prof)
+    return;
+  m->counts.received_bytes += m->received.buffer.capacity;
+  ++m->counts.received_messages;
+}
+
+static void ended(pcu_msg* m)
+{
+  double now;
+  if (!m->prof)
+    return;
+  now = pcu_mpi_time();
+  m->counts.wait += now - m->counts.wait_begin;
+  m->counts.wall = now - m->counts.begin;
+}
+
 bool pcu_msg_receive(pcu_mpi_t* mpi, pcu_msg* m)
 {
   if ((m->state != send_recv_state)&&
@@ -203,14 +711,33 @@ bool pcu_msg_receive(pcu_mpi_t* mpi, pcu_msg* m)
     reel_fail("PCU_Comm_Receive called at the wrong time");
   if ( ! pcu_msg_unpacked(m))
     reel_fail("PCU_Comm_Receive called before previous message unpacked");
-  if (receive_global(mpi, m))
+  if (m->nbors) {
+    if (receive_neighbors(mpi, m)) {
+      received(m);
+      return true;
+    }
+    /* keep the received buffer for the next phase */
+    m->state = idle_state;
+    ended(m);
+    return false;
+  }
+  if (m->routed_phase) {
+    if (receive_routed(m)) {
+      received(m);
+      return true;
+    }
+    if (m->prof)
+      m->counts.wait_begin = pcu_mpi_time();
+  }
+  else if (receive_global(mpi, m))
   {
-    pcu_begin_buffer(&(m->received.buffer));
+    received(m);
     return true;
   }
   m->state = idle_state;
   free_comm(m);
   make_comm(m);
+  ended(m);
   return false;
 }
 
@@ -237,6 +764,9 @@ size_t pcu_msg_received_size(pcu_msg* m)
 void pcu_free_msg(pcu_msg* m)
 {
   free_comm(m);
+  free_neighbors(m);
+  noto_free(m->arena);
+  pcu_free_buffer(&(m->routed));
   if (m->file)
     fclose(m->file);
 }
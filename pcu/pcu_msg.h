@@ -29,31 +29,81 @@ typedef struct
 {
   pcu_aa_node node; //binary tree node for lookup
   pcu_message message; //send buffer and peer id
+  size_t counted; //bytes declared by pcu_msg_count
+  bool in_arena; //the send buffer is a slice of pcu_msg.arena
 } pcu_msg_peer;
 
+/* a send buffer sent before pcu_msg_send by pcu_msg_flush */
+typedef struct pcu_msg_flushed
+{
+  struct pcu_msg_flushed* next;
+  pcu_message message;
+  bool in_arena;
+} pcu_msg_flushed;
+
 struct pcu_order_struct;
+struct pcu_prof;
+
+/* what the current phase cost, recorded while profiling */
+typedef struct
+{
+  double begin; //time at pcu_msg_start
+  double wait_begin; //time the termination barrier began
+  double wall; //from pcu_msg_start to the end of the phase
+  double wait; //in the barriers and waiting for sends to finish
+  size_t sent_bytes;
+  int sent_messages;
+  size_t received_bytes;
+  int received_messages;
+} pcu_msg_counts;
 
 struct pcu_msg_struct
 {
   pcu_aa_tree peers; //binary tree of send buffers
+  pcu_msg_peer* last_peer; //the peer packed for most recently
+  pcu_msg_flushed* flushed; //sent while packing, newest first
+  bool counting; //counts were declared but not allocated yet
+  bool packed; //something was packed in this phase
+  char* arena; //memory of the counted send buffers, reused
+  size_t arena_size;
   pcu_message received; //current received buffer
   pcu_coll coll; //collective operation object
   int state; //state within a communication phase
-  /* below this point are variables that just need
-     to be thread-specific but have been tacked onto
-     pcu_msg. if this gets out of hand, create a
-     pcu_thread struct to or something */
+  /* the neighborhood mode, used while nbors is not NULL:
+     each phase exchanges one message with every neighbor,
+     so it ends without a collective */
+  int* nbors; //sorted peer ranks, including this one
+  int nbor_count;
+  int* nbor_index; //index in nbors of each rank, or -1
+  pcu_message* outbox; //send buffers, one per neighbor, reused
+  int* waiting; //indices of neighbors not yet heard from
+  int waiting_count;
+  int icoll_tag; //tag of the last non-blocking tree collective
+  /* the hierarchical mode, used while pcu_mpi_t::nodes is set:
+     the messages of a phase travel between nodes in bundles
+     and the ones for this rank wait here to be received */
+  bool routed_phase; //this phase was sent through the nodes
+  pcu_buffer routed; //records of a pcu_route_header and data
+  size_t routed_at; //offset of the next record to receive
+  /* below this point are variables of this object alone
+     that are not part of the phases. Nothing in pcu_msg
+     is shared between objects, which lets each thread
+     use its own */
   FILE* file; //messenger-unique input or output file
   struct pcu_order_struct* order;
+  struct pcu_prof* prof; //phase profile, NULL unless enabled
+  pcu_msg_counts counts; //of the current phase, while profiling
 };
 typedef struct pcu_msg_struct pcu_msg;
 
 void pcu_make_msg(pcu_msg* m);
 void pcu_msg_start(pcu_mpi_t*, pcu_msg* b);
+void pcu_msg_count(pcu_msg* m, int id, size_t size);
 void* pcu_msg_pack(pcu_msg* m, int id, size_t size);
 #define PCU_MSG_PACK(m,id,o) \
 memcpy(pcu_msg_pack(m,id,sizeof(o)),&(o),sizeof(o))
 size_t pcu_msg_packed(pcu_msg* m, int id);
+void pcu_msg_flush(pcu_mpi_t* mpi, pcu_msg* m, int id);
 void pcu_msg_send(pcu_mpi_t *mpi, pcu_msg* m);
 bool pcu_msg_receive(pcu_mpi_t* mpi, pcu_msg* m);
 void* pcu_msg_unpack(pcu_msg* m, size_t size);
@@ -63,6 +113,8 @@ bool pcu_msg_unpacked(pcu_msg* m);
 int pcu_msg_received_from(pcu_msg* m);
 size_t pcu_msg_received_size(pcu_msg* m);
 void pcu_free_msg(pcu_msg* m);
+void pcu_msg_set_neighbors(pcu_mpi_t* mpi, pcu_msg* m,
+    const int* peers, int n);
 
 #ifdef __cplusplus
 }
@@ -9,12 +9,305 @@
 *******************************************************************************/
 #include "pcu_pmpi.h"
 #include "pcu_buffer.h"
+#include "noto_malloc.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <string.h>
 
-void pcu_pmpi_send2(const pcu_mpi_t* self, pcu_message* m, int tag, MPI_Comm comm);
-bool pcu_pmpi_receive2(const pcu_mpi_t*, pcu_message* m, int tag, MPI_Comm comm);
+/* The on-node transport: every rank owns, in an MPI shared
+   window, one slot per rank of its node and communicator.
+   A message small enough is copied by its sender into the
+   slot at the receiver and copied out by the receiver, which
+   empties the slot and so completes the send, the same way
+   a matched MPI_Issend does.
+   A slot holds one message at a time and further ones to that
+   receiver wait in order at the sender.
+   Collective messages of different tags may be waited for in
+   any order, so the receiver moves them out of the slots into
+   a list before matching them. User messages are only ever
+   waited for with one tag at a time and are matched in place. */
+
+typedef struct
+{
+  volatile int full;
+  int tag;
+  size_t size;
+} pcu_shm_slot;
+
+typedef struct
+{
+  pcu_message* message;
+  int tag;
+  int comm;
+} pcu_shm_send;
+
+typedef struct
+{
+  pcu_buffer buffer;
+  int peer;
+  int tag;
+} pcu_shm_stashed;
+
+enum { user_slot, coll_slot, slots_per_rank };
+
+struct pcu_shm
+{
+  MPI_Comm node;
+  MPI_Win win;
+  int size; //ranks on this node
+  int rank; //rank on this node
+  int* local; //node rank of each communicator rank, or -1
+  int* global; //communicator rank of each node rank
+  char** segments; //the slots owned by each node rank
+  size_t capacity; //largest message sent through a slot
+  size_t stride; //bytes from one slot to the next
+  pcu_message** inflight; //our message in each slot, by slot index
+  int inflight_count;
+  pcu_shm_send* queue; //messages waiting for their slot
+  int queue_count;
+  int queue_capacity;
+  pcu_shm_stashed* stash; //collective messages taken from slots
+  int stash_count;
+  int stash_capacity;
+  int next; //node rank at which probing any source starts
+};
+
+static size_t round_up(size_t n)
+{
+  return (n + 63) & ~((size_t)63);
+}
+
+static pcu_shm_slot* get_slot(struct pcu_shm* s, int owner, int sender,
+    int comm)
+{
+  return (pcu_shm_slot*)(s->segments[owner]
+      + (sender * slots_per_rank + comm) * s->stride);
+}
+
+static char* get_payload(pcu_shm_slot* slot)
+{
+  return (char*)slot + round_up(sizeof(pcu_shm_slot));
+}
+
+static struct pcu_shm* make_shm(const pcu_mpi_t* self, size_t capacity)
+{
+  struct pcu_shm* s;
+  char* base;
+  size_t bytes;
+  MPI_Aint segment;
+  int unit;
+  int i;
+  NOTO_MALLOC(s, 1);
+  MPI_Comm_split_type(self->user_comm, MPI_COMM_TYPE_SHARED, 0,
+      MPI_INFO_NULL, &(s->node));
+  MPI_Comm_size(s->node, &(s->size));
+  MPI_Comm_rank(s->node, &(s->rank));
+  s->capacity = capacity;
+  s->stride = round_up(sizeof(pcu_shm_slot)) + round_up(capacity);
+  bytes = s->stride * slots_per_rank * s->size;
+  MPI_Win_allocate_shared((MPI_Aint)bytes, 1, MPI_INFO_NULL, s->node,
+      &base, &(s->win));
+  memset(base, 0, bytes);
+  NOTO_MALLOC(s->segments, s->size);
+  for (i = 0; i < s->size; ++i)
+    MPI_Win_shared_query(s->win, i, &segment, &unit, &(s->segments[i]));
+  NOTO_MALLOC(s->global, s->size);
+  MPI_Allgather(&(self->rank), 1, MPI_INT, s->global, 1, MPI_INT, s->node);
+  NOTO_MALLOC(s->local, self->size);
+  for (i = 0; i < self->size; ++i)
+    s->local[i] = -1;
+  for (i = 0; i < s->size; ++i)
+    s->local[s->global[i]] = i;
+  NOTO_MALLOC(s->inflight, slots_per_rank * s->size);
+  for (i = 0; i < slots_per_rank * s->size; ++i)
+    s->inflight[i] = NULL;
+  s->inflight_count = 0;
+  s->queue = NULL;
+  s->queue_count = s->queue_capacity = 0;
+  s->stash = NULL;
+  s->stash_count = s->stash_capacity = 0;
+  s->next = 0;
+  /* the slots are only ever read and written directly,
+     inside one epoch that lasts as long as the window */
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, s->win);
+  MPI_Win_sync(s->win);
+  MPI_Barrier(s->node);
+  MPI_Win_sync(s->win);
+  return s;
+}
+
+static void free_shm(struct pcu_shm* s)
+{
+  int i;
+  MPI_Win_unlock_all(s->win);
+  MPI_Win_free(&(s->win));
+  MPI_Comm_free(&(s->node));
+  for (i = 0; i < s->stash_count; ++i)
+    pcu_free_buffer(&(s->stash[i].buffer));
+  noto_free(s->stash);
+  noto_free(s->queue);
+  noto_free(s->inflight);
+  noto_free(s->local);
+  noto_free(s->global);
+  noto_free(s->segments);
+  noto_free(s);
+}
+
+static int get_comm(const pcu_mpi_t* self, MPI_Comm comm)
+{
+  return comm == self->coll_comm ? coll_slot : user_slot;
+}
+
+static bool write_slot(struct pcu_shm* s, pcu_shm_send* p)
+{
+  int to = s->local[p->message->peer];
+  int i = to * slots_per_rank + p->comm;
+  pcu_shm_slot* slot;
+  if (s->inflight[i])
+    return false;
+  slot = get_slot(s, to, s->rank, p->comm);
+  slot->tag = p->tag;
+  slot->size = p->message->buffer.size;
+  if (slot->size)
+    memcpy(get_payload(slot), p->message->buffer.start, slot->size);
+  MPI_Win_sync(s->win);
+  slot->full = 1;
+  s->inflight[i] = p->message;
+  ++s->inflight_count;
+  return true;
+}
+
+/* completes the sends whose slots were emptied and writes
+   waiting messages into them. Going through the queue in
+   order keeps messages to one slot in order. */
+static void progress(struct pcu_shm* s)
+{
+  int i, j;
+  int to;
+  if (s->inflight_count) {
+    bool emptied = false;
+    for (i = 0; i < slots_per_rank * s->size; ++i) {
+      if (!s->inflight[i])
+        continue;
+      to = i / slots_per_rank;
+      if (get_slot(s, to, s->rank, i % slots_per_rank)->full)
+        continue;
+      s->inflight[i]->shm_pending = 0;
+      s->inflight[i] = NULL;
+      --s->inflight_count;
+      emptied = true;
+    }
+    if (emptied)
+      MPI_Win_sync(s->win);
+  }
+  for (i = j = 0; i < s->queue_count; ++i)
+    if (!write_slot(s, &(s->queue[i])))
+      s->queue[j++] = s->queue[i];
+  s->queue_count = j;
+}
+
+static void send_shared(struct pcu_shm* s, pcu_message* m, int tag,
+    int comm)
+{
+  if (s->queue_count == s->queue_capacity) {
+    s->queue_capacity = s->queue_capacity * 2 + 8;
+    s->queue = noto_realloc(s->queue,
+        s->queue_capacity * sizeof(pcu_shm_send));
+  }
+  s->queue[s->queue_count].message = m;
+  s->queue[s->queue_count].tag = tag;
+  s->queue[s->queue_count].comm = comm;
+  ++s->queue_count;
+  m->shm_pending = 1;
+  /* so that testing it again once taken succeeds */
+  m->request = MPI_REQUEST_NULL;
+  progress(s);
+}
+
+static void empty_slot(struct pcu_shm* s, pcu_shm_slot* slot)
+{
+  MPI_Win_sync(s->win);
+  slot->full = 0;
+}
+
+static bool take_user(struct pcu_shm* s, int from, pcu_message* m, int tag)
+{
+  pcu_shm_slot* slot = get_slot(s, s->rank, from, user_slot);
+  if (!slot->full)
+    return false;
+  MPI_Win_sync(s->win);
+  if (slot->tag != tag)
+    return false;
+  pcu_resize_buffer(&(m->buffer), slot->size);
+  if (slot->size)
+    memcpy(m->buffer.start, get_payload(slot), slot->size);
+  m->peer = s->global[from];
+  empty_slot(s, slot);
+  return true;
+}
+
+static bool receive_user(struct pcu_shm* s, pcu_message* m, int tag)
+{
+  int i, from;
+  if (m->peer != MPI_ANY_SOURCE) {
+    from = s->local[m->peer];
+    return from >= 0 && take_user(s, from, m, tag);
+  }
+  for (i = 0; i < s->size; ++i) {
+    from = (s->next + i) % s->size;
+    if (take_user(s, from, m, tag)) {
+      s->next = (from + 1) % s->size;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void stash_slots(struct pcu_shm* s)
+{
+  int i;
+  pcu_shm_slot* slot;
+  pcu_shm_stashed* st;
+  for (i = 0; i < s->size; ++i) {
+    slot = get_slot(s, s->rank, i, coll_slot);
+    if (!slot->full)
+      continue;
+    MPI_Win_sync(s->win);
+    if (s->stash_count == s->stash_capacity) {
+      s->stash_capacity = s->stash_capacity * 2 + 8;
+      s->stash = noto_realloc(s->stash,
+          s->stash_capacity * sizeof(pcu_shm_stashed));
+    }
+    st = &(s->stash[s->stash_count++]);
+    pcu_make_buffer(&(st->buffer));
+    pcu_resize_buffer(&(st->buffer), slot->size);
+    if (slot->size)
+      memcpy(st->buffer.start, get_payload(slot), slot->size);
+    st->peer = s->global[i];
+    st->tag = slot->tag;
+    empty_slot(s, slot);
+  }
+}
+
+static bool receive_coll(struct pcu_shm* s, pcu_message* m, int tag)
+{
+  int i;
+  stash_slots(s);
+  for (i = 0; i < s->stash_count; ++i)
+    if (s->stash[i].tag == tag &&
+        (m->peer == MPI_ANY_SOURCE || m->peer == s->stash[i].peer))
+      break;
+  if (i == s->stash_count)
+    return false;
+  pcu_free_buffer(&(m->buffer));
+  m->buffer = s->stash[i].buffer;
+  m->peer = s->stash[i].peer;
+  --s->stash_count;
+  memmove(s->stash + i, s->stash + i + 1,
+      (s->stash_count - i) * sizeof(pcu_shm_stashed));
+  return true;
+}
 
 void pcu_pmpi_init(MPI_Comm comm, pcu_mpi_t* self)
 {
@@ -22,14 +315,103 @@ void pcu_pmpi_init(MPI_Comm comm, pcu_mpi_t* self)
   MPI_Comm_dup(comm,&(self->coll_comm));
   MPI_Comm_size(comm,&(self->size));
   MPI_Comm_rank(comm,&(self->rank));
+  self->native_coll = 1;
+  self->shm = NULL;
+  self->nodes = NULL;
+}
+
+static pcu_mpi_nodes* make_nodes(const pcu_mpi_t* self, int node_size)
+{
+  pcu_mpi_nodes* n;
+  int* leaders;
+  int* ids;
+  int leader = self->rank;
+  int i;
+  NOTO_MALLOC(n, 1);
+  if (node_size > 0)
+    MPI_Comm_split(self->user_comm, self->rank / node_size, self->rank,
+        &(n->node_comm));
+  else
+    MPI_Comm_split_type(self->user_comm, MPI_COMM_TYPE_SHARED, self->rank,
+        MPI_INFO_NULL, &(n->node_comm));
+  MPI_Bcast(&leader, 1, MPI_INT, 0, n->node_comm);
+  MPI_Comm_split(self->user_comm,
+      leader == self->rank ? 0 : MPI_UNDEFINED, self->rank,
+      &(n->leader_comm));
+  NOTO_MALLOC(leaders, self->size);
+  MPI_Allgather(&leader, 1, MPI_INT, leaders, 1, MPI_INT, self->user_comm);
+  /* number the nodes in the order of their leaders, which
+     come before the other ranks of their nodes */
+  NOTO_MALLOC(ids, self->size);
+  NOTO_MALLOC(n->node, self->size);
+  n->nodes = 0;
+  for (i = 0; i < self->size; ++i) {
+    if (leaders[i] == i)
+      ids[i] = n->nodes++;
+    n->node[i] = ids[leaders[i]];
+  }
+  NOTO_MALLOC(n->node_begin, n->nodes + 1);
+  for (i = 0; i <= n->nodes; ++i)
+    n->node_begin[i] = 0;
+  for (i = 0; i < self->size; ++i)
+    ++n->node_begin[n->node[i] + 1];
+  for (i = 0; i < n->nodes; ++i)
+    n->node_begin[i + 1] += n->node_begin[i];
+  NOTO_MALLOC(n->node_ranks, self->size);
+  NOTO_MALLOC(n->local, self->size);
+  for (i = 0; i < n->nodes; ++i)
+    ids[i] = n->node_begin[i];
+  for (i = 0; i < self->size; ++i) {
+    n->local[i] = ids[n->node[i]] - n->node_begin[n->node[i]];
+    n->node_ranks[ids[n->node[i]]++] = i;
+  }
+  noto_free(ids);
+  noto_free(leaders);
+  return n;
+}
+
+static void free_nodes(pcu_mpi_nodes* n)
+{
+  MPI_Comm_free(&(n->node_comm));
+  if (n->leader_comm != MPI_COMM_NULL)
+    MPI_Comm_free(&(n->leader_comm));
+  noto_free(n->node);
+  noto_free(n->local);
+  noto_free(n->node_begin);
+  noto_free(n->node_ranks);
+  noto_free(n);
+}
+
+void pcu_pmpi_set_nodes(pcu_mpi_t* self, bool on, int node_size)
+{
+  if (self->nodes)
+    free_nodes(self->nodes);
+  self->nodes = NULL;
+  if (on)
+    self->nodes = make_nodes(self, node_size);
 }
 
 void pcu_pmpi_finalize(pcu_mpi_t* self)
 {
+  if (self->shm)
+    free_shm(self->shm);
+  self->shm = NULL;
+  if (self->nodes)
+    free_nodes(self->nodes);
+  self->nodes = NULL;
   MPI_Comm_free(&(self->user_comm));
   MPI_Comm_free(&(self->coll_comm));
 }
 
+void pcu_pmpi_shared(pcu_mpi_t* self, size_t capacity)
+{
+  if (self->shm)
+    free_shm(self->shm);
+  self->shm = NULL;
+  if (capacity)
+    self->shm = make_shm(self, capacity);
+}
+
 int pcu_pmpi_split(const pcu_mpi_t *mpi, int color, int key, MPI_Comm* newcomm)
 {
   return MPI_Comm_split(mpi->user_comm,color,key,newcomm);
@@ -57,8 +439,12 @@ void pcu_pmpi_send(const pcu_mpi_t* self, pcu_message* m, MPI_Comm comm)
 
 void pcu_pmpi_send2(const pcu_mpi_t* self, pcu_message* m, int tag, MPI_Comm comm)
 {
-  // silence warning
-  (void)self;
+  struct pcu_shm* s = self->shm;
+  if (s && m->buffer.size <= s->capacity && s->local[m->peer] >= 0) {
+    send_shared(s, m, tag, get_comm(self, comm));
+    return;
+  }
+  m->shm_pending = 0;
   if( m->buffer.size > (size_t)INT_MAX ) {
     fprintf(stderr, "ERROR PCU message size exceeds INT_MAX... exiting\n");
     abort();
@@ -75,8 +461,10 @@ void pcu_pmpi_send2(const pcu_mpi_t* self, pcu_message* m, int tag, MPI_Comm com
 
 bool pcu_pmpi_done(const pcu_mpi_t* self, pcu_message* m)
 {
-  // silence warning
-  (void)self;
+  if (m->shm_pending) {
+    progress(self->shm);
+    return !m->shm_pending;
+  }
   int flag;
   MPI_Test(&(m->request),&flag,MPI_STATUS_IGNORE);
   return flag;
@@ -91,8 +479,15 @@ bool pcu_pmpi_receive(const pcu_mpi_t* self, pcu_message* m, MPI_Comm comm)
 
 bool pcu_pmpi_receive2(const pcu_mpi_t* self, pcu_message* m, int tag, MPI_Comm comm)
 {
-  // silence warning
-  (void)self;
+  struct pcu_shm* s = self->shm;
+  if (s) {
+    progress(s);
+    if (get_comm(self, comm) == coll_slot) {
+      if (receive_coll(s, m, tag))
+        return true;
+    } else if (receive_user(s, m, tag))
+      return true;
+  }
   MPI_Status status;
   int flag;
   MPI_Iprobe(m->peer,tag,comm,&flag,&status);
@@ -113,3 +508,118 @@ bool pcu_pmpi_receive2(const pcu_mpi_t* self, pcu_message* m, int tag, MPI_Comm
   return true;
 }
 
+
+static MPI_Datatype get_type(enum pcu_mpi_type type)
+{
+  switch (type) {
+    case PCU_MPI_INT:
+      return MPI_INT;
+    case PCU_MPI_LONG:
+      return MPI_LONG;
+    case PCU_MPI_SIZE_T:
+      if (sizeof(size_t) == sizeof(unsigned long))
+        return MPI_UNSIGNED_LONG;
+      return MPI_UNSIGNED_LONG_LONG;
+    case PCU_MPI_DOUBLE:
+      return MPI_DOUBLE;
+  }
+  return MPI_DATATYPE_NULL;
+}
+
+static MPI_Op get_op(enum pcu_mpi_op op)
+{
+  switch (op) {
+    case PCU_MPI_SUM:
+      return MPI_SUM;
+    case PCU_MPI_MIN:
+      return MPI_MIN;
+    case PCU_MPI_MAX:
+      return MPI_MAX;
+  }
+  return MPI_OP_NULL;
+}
+
+static int get_count(size_t n)
+{
+  if (n > (size_t)INT_MAX) {
+    fprintf(stderr, "ERROR PCU collective size exceeds INT_MAX... exiting\n");
+    abort();
+  }
+  return (int)n;
+}
+
+/* reduces within each node, then among the node leaders,
+   and broadcasts the result back within each node */
+static void allreduce_nodes(const pcu_mpi_t* self, void* data, int count,
+    MPI_Datatype type, MPI_Op op)
+{
+  pcu_mpi_nodes* n = self->nodes;
+  bool leader = n->leader_comm != MPI_COMM_NULL;
+  if (leader)
+    MPI_Reduce(MPI_IN_PLACE, data, count, type, op, 0, n->node_comm);
+  else
+    MPI_Reduce(data, NULL, count, type, op, 0, n->node_comm);
+  if (leader)
+    MPI_Allreduce(MPI_IN_PLACE, data, count, type, op, n->leader_comm);
+  MPI_Bcast(data, count, type, 0, n->node_comm);
+}
+
+void pcu_pmpi_allreduce(const pcu_mpi_t* self, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op)
+{
+  if (self->nodes) {
+    allreduce_nodes(self, data, get_count(n), get_type(type), get_op(op));
+    return;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, data, get_count(n), get_type(type),
+      get_op(op), self->coll_comm);
+}
+
+void pcu_pmpi_exscan(const pcu_mpi_t* self, void* data, size_t n,
+    enum pcu_mpi_type type)
+{
+  MPI_Datatype t = get_type(type);
+  int size;
+  MPI_Exscan(MPI_IN_PLACE, data, get_count(n), t, MPI_SUM, self->coll_comm);
+  /* MPI leaves the result undefined on rank 0 */
+  if (!self->rank) {
+    MPI_Type_size(t, &size);
+    memset(data, 0, n * size);
+  }
+}
+
+void pcu_pmpi_allgather(const pcu_mpi_t* self, const void* send, void* recv,
+    size_t n, enum pcu_mpi_type type)
+{
+  MPI_Datatype t = get_type(type);
+  int count = get_count(n);
+  MPI_Allgather(send, count, t, recv, count, t, self->coll_comm);
+}
+
+void pcu_pmpi_iallreduce(const pcu_mpi_t* self, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op, PCU_Request* r)
+{
+  MPI_Iallreduce(MPI_IN_PLACE, data, get_count(n), get_type(type),
+      get_op(op), self->coll_comm, r);
+}
+
+/* note that this leaves the result on rank 0 undefined */
+void pcu_pmpi_iexscan(const pcu_mpi_t* self, void* data, size_t n,
+    enum pcu_mpi_type type, PCU_Request* r)
+{
+  MPI_Iexscan(MPI_IN_PLACE, data, get_count(n), get_type(type), MPI_SUM,
+      self->coll_comm, r);
+}
+
+bool pcu_pmpi_test(const pcu_mpi_t* self, PCU_Request* r)
+{
+  (void)self;
+  int flag;
+  MPI_Test(r, &flag, MPI_STATUS_IGNORE);
+  return flag;
+}
+
+double pcu_pmpi_time(void)
+{
+  return MPI_Wtime();
+}
@@ -23,9 +23,26 @@ int pcu_pmpi_rank(const pcu_mpi_t *self);
 void pcu_pmpi_send(const pcu_mpi_t *, pcu_message *m, PCU_Comm comm);
 bool pcu_pmpi_receive(const pcu_mpi_t *, pcu_message *m, PCU_Comm comm);
 bool pcu_pmpi_done(const pcu_mpi_t *, pcu_message *m);
+void pcu_pmpi_send2(const pcu_mpi_t *, pcu_message *m, int tag, PCU_Comm comm);
+bool pcu_pmpi_receive2(const pcu_mpi_t *, pcu_message *m, int tag,
+    PCU_Comm comm);
 
 int pcu_pmpi_split(const pcu_mpi_t *, int color, int key, PCU_Comm* newcomm);
 int pcu_pmpi_dup(const pcu_mpi_t *, PCU_Comm* newcomm);
+void pcu_pmpi_allreduce(const pcu_mpi_t *, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op);
+void pcu_pmpi_exscan(const pcu_mpi_t *, void* data, size_t n,
+    enum pcu_mpi_type type);
+void pcu_pmpi_allgather(const pcu_mpi_t *, const void* send, void* recv,
+    size_t n, enum pcu_mpi_type type);
+void pcu_pmpi_iallreduce(const pcu_mpi_t *, void* data, size_t n,
+    enum pcu_mpi_type type, enum pcu_mpi_op op, PCU_Request* r);
+void pcu_pmpi_iexscan(const pcu_mpi_t *, void* data, size_t n,
+    enum pcu_mpi_type type, PCU_Request* r);
+bool pcu_pmpi_test(const pcu_mpi_t *, PCU_Request* r);
+void pcu_pmpi_shared(pcu_mpi_t *, size_t capacity);
+double pcu_pmpi_time(void);
+void pcu_pmpi_set_nodes(pcu_mpi_t *, bool on, int node_size);
 
 #ifdef __cplusplus
 }
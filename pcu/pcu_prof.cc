@@ -0,0 +1,251 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#include "pcu_prof.h"
+#include "PCU.h"
+#include "reel.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <dlfcn.h>
+#define PCU_HAS_DLADDR
+#endif
+
+namespace {
+
+enum {
+  PHASES,
+  WALL,
+  WAIT,
+  SENT_BYTES,
+  SENT_MESSAGES,
+  RECEIVED_BYTES,
+  RECEIVED_MESSAGES,
+  MAX_PEERS,
+  STAT_COUNT
+};
+
+const char* const statNames[STAT_COUNT] = {
+  "phases",
+  "wall",
+  "wait",
+  "sent_bytes",
+  "sent_messages",
+  "received_bytes",
+  "received_messages",
+  "max_peers"
+};
+
+struct Stats {
+  Stats() { std::fill(v, v + STAT_COUNT, 0.0); }
+  void add(Stats const& o) {
+    for (int i = 0; i < STAT_COUNT; ++i)
+      v[i] = (i == MAX_PEERS) ? std::max(v[i], o.v[i]) : v[i] + o.v[i];
+  }
+  double v[STAT_COUNT];
+};
+
+typedef std::map<std::string, Stats> Table;
+typedef std::vector<std::pair<int, Stats> > RankStats;
+
+/* names a call site the same way on every rank,
+   regardless of where its library was loaded */
+std::string getSiteName(const void* site) {
+  char s[64];
+#ifdef PCU_HAS_DLADDR
+  Dl_info info;
+  if (site && dladdr(site, &info) && info.dli_fname) {
+    std::string name;
+    const void* from;
+    if (info.dli_sname) {
+      name = info.dli_sname;
+      from = info.dli_saddr;
+    } else {
+      name = info.dli_fname;
+      name = name.substr(name.find_last_of('/') + 1);
+      from = info.dli_fbase;
+    }
+    snprintf(s, sizeof(s), "+0x%lx", static_cast<unsigned long>(
+          static_cast<const char*>(site) - static_cast<const char*>(from)));
+    return name + s;
+  }
+#endif
+  snprintf(s, sizeof(s), "%p", site);
+  return s;
+}
+
+void writeCsvString(FILE* f, std::string const& s) {
+  fputc('"', f);
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '"')
+      fputc('"', f);
+    fputc(s[i], f);
+  }
+  fputc('"', f);
+}
+
+void writeJsonString(FILE* f, std::string const& s) {
+  fputc('"', f);
+  for (size_t i = 0; i < s.size(); ++i) {
+    unsigned char c = s[i];
+    if (c == '"' || c == '\\')
+      fprintf(f, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(f, "\\u%04x", c);
+    else
+      fputc(c, f);
+  }
+  fputc('"', f);
+}
+
+FILE* openFile(std::string const& path) {
+  FILE* f = fopen(path.c_str(), "w");
+  if (!f)
+    reel_fail("PCU: could not open profile \"%s\"\n", path.c_str());
+  return f;
+}
+
+/* one row per rank and label */
+void writeCsv(std::string const& path, std::map<std::string, RankStats>& all) {
+  FILE* f = openFile(path);
+  fprintf(f, "rank,label");
+  for (int i = 0; i < STAT_COUNT; ++i)
+    fprintf(f, ",%s", statNames[i]);
+  fprintf(f, "\n");
+  for (auto& label : all)
+    for (auto& rank : label.second) {
+      fprintf(f, "%d,", rank.first);
+      writeCsvString(f, label.first);
+      for (int i = 0; i < STAT_COUNT; ++i)
+        fprintf(f, ",%.9g", rank.second.v[i]);
+      fprintf(f, "\n");
+    }
+  fclose(f);
+}
+
+/* the spread of each statistic over the ranks of each label,
+   with the labels that took the longest on some rank first */
+void writeJson(std::string const& path, int peers,
+    std::map<std::string, RankStats>& all) {
+  std::vector<std::pair<double, std::string> > order;
+  for (auto& label : all) {
+    double wall = 0;
+    for (auto& rank : label.second)
+      wall = std::max(wall, rank.second.v[WALL]);
+    order.push_back(std::make_pair(-wall, label.first));
+  }
+  std::sort(order.begin(), order.end());
+  FILE* f = openFile(path);
+  fprintf(f, "{\n  \"ranks\": %d,\n  \"phases\": [", peers);
+  for (size_t l = 0; l < order.size(); ++l) {
+    RankStats& ranks = all[order[l].second];
+    fprintf(f, "%s\n    {\n      \"label\": ", l ? "," : "");
+    writeJsonString(f, order[l].second);
+    fprintf(f, ",\n      \"ranks\": %zu", ranks.size());
+    for (int i = 0; i < STAT_COUNT; ++i) {
+      double min = ranks[0].second.v[i];
+      double max = min;
+      double sum = 0;
+      for (auto& rank : ranks) {
+        min = std::min(min, rank.second.v[i]);
+        max = std::max(max, rank.second.v[i]);
+        sum += rank.second.v[i];
+      }
+      fprintf(f, ",\n      \"%s\": "
+          "{\"min\": %.9g, \"max\": %.9g, \"avg\": %.9g}",
+          statNames[i], min, max, sum / ranks.size());
+    }
+    fprintf(f, "\n    }");
+  }
+  fprintf(f, "\n  ]\n}\n");
+  fclose(f);
+}
+
+}
+
+struct pcu_prof {
+  std::string path;
+  bool labeled; //the current phase has a label
+  std::string label;
+  const void* site;
+  Table labels;
+  std::map<const void*, Stats> sites;
+};
+
+pcu_prof* pcu_prof_new(const char* path) {
+  pcu_prof* p = new pcu_prof;
+  p->path = path;
+  p->labeled = false;
+  p->site = nullptr;
+  return p;
+}
+
+void pcu_prof_begin(pcu_prof* p, const char* label, const void* site) {
+  p->labeled = label;
+  if (label)
+    p->label = label;
+  p->site = site;
+}
+
+void pcu_prof_end(pcu_prof* p, const pcu_msg_counts* c) {
+  Stats s;
+  s.v[PHASES] = 1;
+  s.v[WALL] = c->wall;
+  s.v[WAIT] = c->wait;
+  s.v[SENT_BYTES] = c->sent_bytes;
+  s.v[SENT_MESSAGES] = c->sent_messages;
+  s.v[RECEIVED_BYTES] = c->received_bytes;
+  s.v[RECEIVED_MESSAGES] = c->received_messages;
+  s.v[MAX_PEERS] = c->sent_messages;
+  if (p->labeled)
+    p->labels[p->label].add(s);
+  else
+    p->sites[p->site].add(s);
+}
+
+void pcu_prof_write(pcu_prof* p, pcu::PCU& pcu) {
+  Table table = p->labels;
+  for (auto& site : p->sites)
+    table[getSiteName(site.first)].add(site.second);
+  pcu.Begin();
+  for (auto& label : table) {
+    pcu.PackSized(0, label.first.data(), label.first.size());
+    pcu.PackArray(0, label.second.v, STAT_COUNT);
+  }
+  pcu.Send();
+  std::map<std::string, RankStats> all;
+  while (pcu.Receive()) {
+    int from = pcu.Sender();
+    while (!pcu.Unpacked()) {
+      std::vector<char> label;
+      pcu.UnpackSized(label);
+      Stats s;
+      pcu.UnpackArray(s.v, STAT_COUNT);
+      all[std::string(label.begin(), label.end())].push_back(
+          std::make_pair(from, s));
+    }
+  }
+  if (pcu.Self())
+    return;
+  for (auto& label : all)
+    std::sort(label.second.begin(), label.second.end(),
+        [](std::pair<int, Stats> const& a, std::pair<int, Stats> const& b) {
+          return a.first < b.first;
+        });
+  writeCsv(p->path + ".csv", all);
+  writeJson(p->path + ".json", pcu.Peers(), all);
+}
+
+void pcu_prof_free(pcu_prof* p) {
+  delete p;
+}
@@ -0,0 +1,29 @@
+/******************************************************************************
+
+  Copyright 2014 Scientific Computation Research Center,
+      Rensselaer Polytechnic Institute. All rights reserved.
+
+  This work is open source software, licensed under the terms of the
+  BSD license as described in the LICENSE file in the top-level directory.
+
+*******************************************************************************/
+#ifndef PCU_PROF_H
+#define PCU_PROF_H
+
+#include "pcu_msg.h"
+
+namespace pcu {
+class PCU;
+}
+
+struct pcu_prof;
+
+pcu_prof* pcu_prof_new(const char* path);
+/* label may be NULL, the phase is then filed under site */
+void pcu_prof_begin(pcu_prof* p, const char* label, const void* site);
+void pcu_prof_end(pcu_prof* p, const pcu_msg_counts* counts);
+/* collective, gathers the profiles and writes them from rank 0 */
+void pcu_prof_write(pcu_prof* p, pcu::PCU& pcu);
+void pcu_prof_free(pcu_prof* p);
+
+#endif
@@ -35,6 +35,7 @@ include_directories("${PROJECT_BINARY_DIR}")
 set(SOURCES
         pcu_c.cc
         pcu_aa.c
+        pcu_batch.cc
         pcu_coll.c
         pcu_io.c
         pcu_buffer.c
@@ -42,6 +43,7 @@ set(SOURCES
         pcu_mpi.c
         pcu_msg.c
         pcu_order.c
+        pcu_prof.cc
         pcu_util.c
         noto/noto_malloc.c
         reel/reel.c
@@ -60,6 +62,7 @@ set(HEADERS
         reel/reel.h
         pcu_defines.h
         PCU.h
+        pcu_batch.h
         )
 
 if(SCOREC_NO_MPI)
@@ -69,6 +72,7 @@ tribits_add_library(
    pcu
    HEADERS ${HEADERS}
    SOURCES ${SOURCES})
+target_link_libraries(pcu ${CMAKE_DL_LIBS})
 
 if (PCU_COMPRESS)
   include_directories(${BZIP_INCLUDE_DIR})
@@ -10,10 +10,14 @@
 
 namespace ree {
 
-static void computeResidualBLF(apf::Mesh* mesh, apf::MeshEntity* e,
-  apf::Field* f, apf::Field* fp1, mth::Vector<double>& blf)
+/* me, fel and fp1el are reused across elements by the caller,
+   rebound to each element before this is called */
+static void computeResidualBLF(apf::MeshElement* me, apf::Element* fel,
+  apf::Element* fp1el, mth::Vector<double>& blf)
 {
-  apf::FieldShape* fp1s = fp1->getShape();
+  apf::Mesh* mesh = fel->getMesh();
+  apf::MeshEntity* e = apf::getMeshEntity(me);
+  apf::FieldShape* fp1s = fp1el->getFieldShape();
   int type = mesh->getType(e);
   PCU_ALWAYS_ASSERT(type == apf::Mesh::TET);
   int nd = apf::countElementNodes(fp1s, type);
@@ -28,9 +32,6 @@ static void computeResidualBLF(apf::Mesh* mesh, apf::MeshEntity* e,
   mth::Vector<double> mass_vec (nd);
   blf.resize(nd);
 
-  apf::MeshElement* me = apf::createMeshElement(mesh, e);
-  apf::Element* fp1el = apf::createElement(fp1, me);
-  apf::Element* fel = apf::createElement(f, me);
   int int_order = 2 * fp1s->getOrder();
   int np = apf::countIntPoints(me, int_order);
 
@@ -47,7 +48,7 @@ static void computeResidualBLF(apf::Mesh* mesh, apf::MeshEntity* e,
     apf::getCurl(fel, p, curl);
 
     // get curlshape values
-    fp1el->getShape()->getLocalVectorCurls(mesh, e, p, curlshape);
+    fp1el->getLocalVectorCurls(p, curlshape);
     phys_curlshape.zero();
     for (int i = 0; i < nd; i++)
       for (int j = 0; j < dim; j++)
@@ -103,10 +104,6 @@ static void computeResidualBLF(apf::Mesh* mesh, apf::MeshEntity* e,
   blf.zero();
   blf += curlcurl_vec;
   blf += mass_vec;
-
-  apf::destroyElement(fel);
-  apf::destroyElement(fp1el);
-  apf::destroyMeshElement(me);
 }
 
 static void computeLambdaVector(
@@ -365,8 +362,20 @@ apf::Field* computeErrorField(apf::Field* ef, apf::Field* correctedFlux)
 
   // 2. iterate over all elements of the mesh
   apf::MeshEntity* el;
+  apf::MeshElement* me = 0;
+  apf::Element* fel = 0;
+  apf::Element* fp1el = 0;
   apf::MeshIterator* it = apf::getMesh(ef)->begin(3);
   while ((el = apf::getMesh(ef)->iterate(it))) {
+    if (me) {
+      apf::resetMeshElement(me, el);
+      apf::resetElement(fel, el);
+      apf::resetElement(fp1el, el);
+    } else {
+      me = apf::createMeshElement(apf::getMesh(ef), el);
+      fel = apf::createElement(ef, me);
+      fp1el = apf::createElement(efp1, me);
+    }
 
     // 2(a). Assemble LHS element matrix
     mth::Matrix<double> A;
@@ -374,7 +383,7 @@ apf::Field* computeErrorField(apf::Field* ef, apf::Field* correctedFlux)
 
     // 2(b). Compute Bilinear Form Vector
     mth::Vector<double> blf;
-    computeResidualBLF(apf::getMesh(efp1), el, ef, efp1, blf);
+    computeResidualBLF(me, fel, fp1el, blf);
 
     // 2(c). Compute Linear Form Vector
     mth::Vector<double> lf;
@@ -424,6 +433,11 @@ apf::Field* computeErrorField(apf::Field* ef, apf::Field* correctedFlux)
     apf::setScalar(error_field, el, 0, l2_error);
   }
   apf::getMesh(ef)->end(it);
+  if (me) {
+    apf::destroyElement(fp1el);
+    apf::destroyElement(fel);
+    apf::destroyMeshElement(me);
+  }
   apf::destroyField(efp1);
 
   return error_field;
@@ -197,7 +197,7 @@ void assembleCurlCurlElementMatrix(apf::Mesh* mesh, apf::MeshEntity* e,
     w = weight / jdet;
 
     if (dim == 3) {
-      el->getShape()->getLocalVectorCurls(mesh, e, p, curlshape);
+      el->getLocalVectorCurls(p, curlshape);
       phys_curlshape.zero();
       for (int j = 0; j < nd; j++)
         for (int k = 0; k < dim; k++)
@@ -198,16 +198,21 @@ static void getSamplePoints(Patch* p)
   int nc = apf::countComponents(r->f);
   s->allocate(np,nc);
   std::size_t i = 0;
+  apf::MeshElement* me = 0;
   APF_ITERATE(EntitySet, p->elements, it) {
-    apf::MeshElement* me = apf::createMeshElement(r->mesh, *it);
+    if (me)
+      apf::resetMeshElement(me, *it);
+    else
+      me = apf::createMeshElement(r->mesh, *it);
     for (int l = 0; l < r->points_per_element; ++l) {
       apf::Vector3 param;
       apf::getIntPoint(me, r->order, l, param);
       apf::mapLocalToGlobal(me, param, s->points[i]);
       ++i;
     }
-    apf::destroyMeshElement(me);
   }
+  if (me)
+    apf::destroyMeshElement(me);
 }
 
 static void getSampleValues(Patch* p)
@@ -0,0 +1,112 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <map>
+#include <vector>
+
+typedef std::map<apf::MeshEntity*, std::vector<int> > Sharing;
+
+static void getSharing(apf::Mesh2* m, Sharing& s)
+{
+  s.clear();
+  for (int d = 0; d < m->getDimension(); ++d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      if (!m->isShared(e))
+        continue;
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      APF_ITERATE(apf::Copies, remotes, rit) {
+        s[e].push_back(rit->first);
+        /* the copy must point back at us */
+        PCU_ALWAYS_ASSERT(rit->second);
+      }
+    }
+    m->end(it);
+  }
+}
+
+static void clearPart(apf::Mesh2* m)
+{
+  for (int d = m->getDimension(); d >= 0; --d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it)))
+      m->destroy(e);
+    m->end(it);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  PCU_ALWAYS_ASSERT(PCUObj.Peers() == 2);
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, &PCUObj);
+  if (PCUObj.Self())
+    clearPart(m);
+  /* split the box in half along x */
+  apf::Migration* plan = new apf::Migration(m);
+  if (!PCUObj.Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it)))
+      if (apf::getLinearCentroid(m, e).x() > 0.5)
+        plan->send(e, 1);
+    m->end(it);
+  }
+  m->migrate(plan);
+  PCU_ALWAYS_ASSERT(apf::isMdsRemotesCompact(m));
+  Sharing compact;
+  getSharing(m, compact);
+  PCU_ALWAYS_ASSERT(!compact.empty());
+  /* a 5x5 plane of shared vertices at x = 0.5 */
+  size_t verts = 0;
+  APF_ITERATE(Sharing, compact, it)
+    if (!m->getType(it->first))
+      ++verts;
+  PCU_ALWAYS_ASSERT(verts == 25);
+  apf::alignMdsRemotes(m);
+  PCU_ALWAYS_ASSERT(apf::isMdsRemotesCompact(m));
+  Sharing aligned;
+  getSharing(m, aligned);
+  PCU_ALWAYS_ASSERT(aligned == compact);
+  apf::verify(m);
+  /* changing the copies unpacks the table */
+  apf::MeshEntity* v = compact.begin()->first;
+  apf::Copies remotes;
+  m->getRemotes(v, remotes);
+  m->clearRemotes(v);
+  PCU_ALWAYS_ASSERT(!apf::isMdsRemotesCompact(m));
+  PCU_ALWAYS_ASSERT(!m->isShared(v));
+  m->setRemotes(v, remotes);
+  Sharing expanded;
+  getSharing(m, expanded);
+  PCU_ALWAYS_ASSERT(expanded == compact);
+  /* and migrating back packs it again */
+  plan = new apf::Migration(m);
+  if (PCUObj.Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it)))
+      plan->send(e, 0);
+    m->end(it);
+  }
+  m->migrate(plan);
+  PCU_ALWAYS_ASSERT(apf::isMdsRemotesCompact(m));
+  getSharing(m, compact);
+  PCU_ALWAYS_ASSERT(compact.empty());
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
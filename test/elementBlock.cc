@@ -0,0 +1,159 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfElementBlock.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <vector>
+
+static double const tolerance = 1e-10;
+
+static void close(double a, double b)
+{
+  PCU_ALWAYS_ASSERT(std::fabs(a - b) <= tolerance * (1 + std::fabs(b)));
+}
+
+static apf::Vector3 function(apf::Vector3 const& x)
+{
+  return apf::Vector3(x[0] + 1, x[1] * x[1], x[0] * x[2] - x[1]);
+}
+
+/* values at the nodes of each entity, for shapes with
+   at most one node per entity placed at its centroid */
+static apf::Field* makeField(apf::Mesh* m, apf::FieldShape* s, int type)
+{
+  apf::Field* f = apf::createField(m, "f", type, s);
+  for (int d = 0; d <= m->getDimension(); ++d) {
+    if (!s->hasNodesIn(d))
+      continue;
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      int n = s->countNodesOn(m->getType(e));
+      for (int i = 0; i < n; ++i) {
+        apf::Vector3 x = apf::getLinearCentroid(m, e);
+        x[0] += i * 0.01;
+        apf::Vector3 v = function(x);
+        if (type == apf::SCALAR)
+          apf::setScalar(f, e, i, v[2]);
+        else
+          apf::setVector(f, e, i, v);
+      }
+    }
+    m->end(it);
+  }
+  return f;
+}
+
+/* compare one block against the one-element-at-a-time path */
+static void checkBlock(apf::ElementBlock& b, apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  int nc = apf::countComponents(f);
+  int dim = b.getDimension();
+  for (int i = 0; i < b.countElements(); ++i) {
+    apf::MeshEntity* e = b.getElements()[i];
+    apf::MeshElement* me = apf::createMeshElement(m, e);
+    apf::Element* el = apf::createElement(f, me);
+    for (int p = 0; p < b.countPoints(); ++p) {
+      apf::Vector3 xi = b.getPoint(p);
+      close(b.getDVs(p)[i], apf::getDV(me, xi));
+      apf::Matrix3x3 J;
+      apf::getJacobian(me, xi, J);
+      apf::Matrix3x3 Jinv;
+      apf::getJacobianInv(me, xi, Jinv);
+      for (int a = 0; a < dim; ++a)
+        for (int j = 0; j < 3; ++j) {
+          close(b.getJacobians(p, a, j)[i], J[a][j]);
+          close(b.getJacobianInverses(p, j, a)[i], Jinv[j][a]);
+        }
+      if (nc == 1) {
+        close(b.getValues(p, 0)[i], apf::getScalar(el, xi));
+        apf::Vector3 g;
+        apf::getGrad(el, xi, g);
+        for (int j = 0; j < 3; ++j)
+          close(b.getGrads(p, 0, j)[i], g[j]);
+      } else {
+        apf::Vector3 v;
+        apf::getVector(el, xi, v);
+        apf::Matrix3x3 g;
+        apf::getVectorGrad(el, xi, g);
+        for (int c = 0; c < 3; ++c) {
+          close(b.getValues(p, c)[i], v[c]);
+          for (int j = 0; j < 3; ++j)
+            close(b.getGrads(p, c, j)[i], g[j][c]);
+        }
+      }
+    }
+    apf::destroyElement(el);
+    apf::destroyMeshElement(me);
+  }
+}
+
+static void checkField(apf::Mesh* m, apf::FieldShape* s, int type,
+    int order, int capacity)
+{
+  apf::Field* f = makeField(m, s, type);
+  int dim = m->getDimension();
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  e = m->iterate(it);
+  apf::ElementBlock b(f, m->getType(e), order, capacity);
+  m->end(it);
+  std::vector<apf::MeshEntity*> elements;
+  it = m->begin(dim);
+  int total = 0;
+  double volume = 0;
+  for (;;) {
+    e = m->iterate(it);
+    if (e)
+      elements.push_back(e);
+    if (elements.size() == size_t(capacity) || (!e && elements.size())) {
+      b.gather(&elements[0], elements.size());
+      b.evaluate();
+      checkBlock(b, f);
+      for (int p = 0; p < b.countPoints(); ++p)
+        for (int i = 0; i < b.countElements(); ++i)
+          volume += b.getWeight(p) * b.getDVs(p)[i];
+      total += b.countElements();
+      elements.clear();
+    }
+    if (!e)
+      break;
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(total == int(m->count(dim)));
+  close(volume, 1);
+  apf::destroyField(f);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(3, 3, 3, 1, 1, 1, true, &PCUObj);
+  checkField(m, apf::getLagrange(1), apf::SCALAR, 2, 64);
+  checkField(m, apf::getLagrange(2), apf::VECTOR, 4, 7);
+  /* no dedicated kernel for these */
+  checkField(m, apf::getLagrange(3), apf::SCALAR, 4, 16);
+  checkField(m, apf::getLagrange(2), apf::VECTOR, 4, 1);
+  apf::changeMeshShape(m, apf::getLagrange(2));
+  checkField(m, apf::getLagrange(2), apf::VECTOR, 4, 9);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::makeMdsBox(4, 4, 0, 1, 1, 0, true, &PCUObj);
+  checkField(m, apf::getLagrange(1), apf::VECTOR, 2, 5);
+  checkField(m, apf::getLagrange(2), apf::SCALAR, 3, 64);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,114 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfIntegrate.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+
+static void close(double a, double b)
+{
+  PCU_ALWAYS_ASSERT(std::fabs(a - b) <= 1e-12 * (1 + std::fabs(b)));
+}
+
+static apf::Field* makeField(apf::Mesh* m)
+{
+  apf::Field* f = apf::createField(m, "f", apf::VECTOR, apf::getLagrange(2));
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 x = apf::getLinearCentroid(m, e);
+      apf::setVector(f, e, 0, apf::Vector3(x[0] * x[1], x[2] + 1, -x[0]));
+    }
+    m->end(it);
+  }
+  return f;
+}
+
+/* compare a rebound element with a fresh one at every integration point */
+static void compare(apf::MeshElement* reused, apf::Element* reusedField,
+    apf::Field* f, apf::MeshEntity* e)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::resetMeshElement(reused, e);
+  apf::resetElement(reusedField, e);
+  PCU_ALWAYS_ASSERT(apf::getMeshEntity(reused) == e);
+  apf::MeshElement* me = apf::createMeshElement(m, e);
+  apf::Element* el = apf::createElement(f, me);
+  int np = apf::countIntPoints(me, 2);
+  for (int p = 0; p < np; ++p) {
+    apf::Vector3 xi;
+    apf::getIntPoint(reused, 2, p, xi);
+    apf::getIntPoint(me, 2, p, xi);
+    close(apf::getDV(reused, xi), apf::getDV(me, xi));
+    apf::Vector3 a, b;
+    apf::getVector(reusedField, xi, a);
+    apf::getVector(el, xi, b);
+    apf::Matrix3x3 ga, gb;
+    apf::getVectorGrad(reusedField, xi, ga);
+    apf::getVectorGrad(el, xi, gb);
+    for (int i = 0; i < 3; ++i) {
+      close(a[i], b[i]);
+      for (int j = 0; j < 3; ++j)
+        close(ga[i][j], gb[i][j]);
+    }
+  }
+  apf::destroyElement(el);
+  apf::destroyMeshElement(me);
+}
+
+class Volume : public apf::Integrator
+{
+  public:
+    Volume():apf::Integrator(1),v(0) {}
+    void atPoint(apf::Vector3 const&, double w, double dV)
+    {
+      v += w * dV;
+    }
+    double v;
+};
+
+static void checkReset(apf::Mesh2* m, apf::Field* f)
+{
+  int dim = m->getDimension();
+  apf::MeshElement* me = apf::createMeshElement(m, apf::getMdsEntity(m, dim, 0));
+  apf::Element* el = apf::createElement(f, me);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it)))
+    compare(me, el, f, e);
+  m->end(it);
+  /* rebinding to other types changes the shape */
+  for (int d = dim - 1; d >= 1; --d)
+    compare(me, el, f, apf::getMdsEntity(m, d, 0));
+  compare(me, el, f, apf::getMdsEntity(m, dim, 1));
+  apf::destroyElement(el);
+  apf::destroyMeshElement(me);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(0);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(2, 2, 2, 1, 1, 1, true, &PCUObj);
+  apf::Field* f = makeField(m);
+  checkReset(m, f);
+  apf::cacheGeometry(m);
+  checkReset(m, f);
+  Volume v;
+  v.process(m);
+  close(v.v, 1);
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,74 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+static void getAll(apf::Mesh* m, int dim, int upDim,
+    std::vector<apf::MeshEntity*>& all)
+{
+  all.clear();
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    apf::Adjacent adj;
+    m->getAdjacent(e, upDim, adj);
+    all.push_back(0);
+    for (size_t i = 0; i < adj.getSize(); ++i)
+      all.push_back(adj[i]);
+    if (upDim == dim + 1) {
+      apf::Up up;
+      m->getUp(e, up);
+      PCU_ALWAYS_ASSERT(up.n == m->countUpward(e));
+      PCU_ALWAYS_ASSERT(up.n == static_cast<int>(adj.getSize()));
+      for (int i = 0; i < up.n; ++i)
+        PCU_ALWAYS_ASSERT(up.e[i] == m->getUpward(e, i));
+    }
+  }
+  m->end(it);
+}
+
+static void checkFrozen(apf::Mesh2* m)
+{
+  std::vector<apf::MeshEntity*> before;
+  std::vector<apf::MeshEntity*> after;
+  int dim = m->getDimension();
+  for (int d = 0; d < dim; ++d)
+    for (int u = d + 1; u <= dim; ++u) {
+      apf::unfreezeMdsAdjacency(m);
+      getAll(m, d, u, before);
+      apf::freezeMdsAdjacency(m);
+      getAll(m, d, u, after);
+      PCU_ALWAYS_ASSERT(before == after);
+    }
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(3, 3, 3, 1, 1, 1, true, &PCUObj);
+  checkFrozen(m);
+  PCU_ALWAYS_ASSERT(apf::isMdsAdjacencyFrozen(m));
+  /* any modification drops the tables */
+  apf::MeshIterator* it = m->begin(0);
+  apf::MeshEntity* v = m->iterate(it);
+  m->end(it);
+  apf::MeshEntity* nv = m->createVert(m->toModel(v));
+  PCU_ALWAYS_ASSERT(!apf::isMdsAdjacencyFrozen(m));
+  apf::freezeMdsAdjacency(m);
+  m->destroy(nv);
+  PCU_ALWAYS_ASSERT(!apf::isMdsAdjacencyFrozen(m));
+  apf::reorderMdsMesh(m);
+  checkFrozen(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,110 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfElement.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+static apf::Vector3 function(apf::Mesh* m, apf::MeshEntity* e)
+{
+  apf::Vector3 x = apf::getLinearCentroid(m, e);
+  return apf::Vector3(x[0] + 1, x[1] * x[2], x[2] - x[0]);
+}
+
+static void setField(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it)))
+      apf::setVector(f, e, 0, function(m, e));
+    m->end(it);
+  }
+}
+
+/* each entity finds its own values, through the raw
+   pointer and through the usual accessors */
+static void checkField(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  double* array = apf::getArrayData(f);
+  size_t nodes = m->count(0) + m->count(1);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 expected = function(m, e);
+      double* p = apf::getArrayData(f, e);
+      PCU_ALWAYS_ASSERT(p >= array && p < array + 3 * nodes);
+      apf::Vector3 v;
+      apf::getVector(f, e, 0, v);
+      for (int i = 0; i < 3; ++i)
+        PCU_ALWAYS_ASSERT(p[i] == expected[i] && v[i] == expected[i]);
+    }
+    m->end(it);
+  }
+  PCU_ALWAYS_ASSERT(!apf::getArrayData(f, apf::getMdsEntity(
+          static_cast<apf::Mesh2*>(m), 2, 0)));
+}
+
+/* element data gathers the same values */
+static void checkElements(apf::Field* f)
+{
+  apf::Mesh* m = apf::getMesh(f);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(3);
+  while ((e = m->iterate(it))) {
+    apf::Element* el = apf::createElement(f, e);
+    apf::NewArray<double> data;
+    el->getElementNodeData(data);
+    apf::Downward down;
+    int k = 0;
+    for (int d = 0; d <= 1; ++d) {
+      int n = m->getDownward(e, d, down);
+      for (int i = 0; i < n; ++i) {
+        double* p = apf::getArrayData(f, down[i]);
+        for (int j = 0; j < 3; ++j)
+          PCU_ALWAYS_ASSERT(data[k++] == p[j]);
+      }
+    }
+    apf::destroyElement(el);
+  }
+  m->end(it);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(0);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(3, 3, 3, 1, 1, 1, true, &PCUObj);
+  apf::Field* f = apf::createField(m, "f", apf::VECTOR, apf::getLagrange(2));
+  setField(f);
+  apf::MeshEntity* v = apf::getMdsEntity(m, 0, 0);
+  PCU_ALWAYS_ASSERT(!apf::getArrayData(f, v));
+  apf::freeze(f);
+  checkField(f);
+  checkElements(f);
+  /* writes go to the same place */
+  apf::setVector(f, v, 0, apf::Vector3(7, 8, 9));
+  PCU_ALWAYS_ASSERT(apf::getArrayData(f, v)[1] == 8);
+  setField(f);
+  /* the tables follow the entities to their new indices */
+  apf::reorderMdsMesh(m);
+  checkField(f);
+  checkElements(f);
+  apf::unfreeze(f);
+  PCU_ALWAYS_ASSERT(!apf::getArrayData(f, v));
+  apf::destroyField(f);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
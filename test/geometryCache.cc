@@ -0,0 +1,146 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+#include <vector>
+
+struct Factors
+{
+  apf::Matrix3x3 J;
+  apf::Matrix3x3 Jinv;
+  double dv;
+};
+
+static Factors getFactors(apf::Mesh* m, apf::MeshEntity* e)
+{
+  Factors f;
+  apf::MeshElement* me = apf::createMeshElement(m, e);
+  apf::Vector3 xi(0.1, 0.2, 0.3);
+  if (m->getDimension() == 2)
+    xi[2] = 0;
+  apf::getJacobian(me, xi, f.J);
+  apf::getJacobianInv(me, xi, f.Jinv);
+  f.dv = apf::getDV(me, xi);
+  apf::destroyMeshElement(me);
+  return f;
+}
+
+static std::vector<Factors> getAllFactors(apf::Mesh* m)
+{
+  std::vector<Factors> all;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  while ((e = m->iterate(it)))
+    all.push_back(getFactors(m, e));
+  m->end(it);
+  return all;
+}
+
+static void same(apf::Matrix3x3 const& a, apf::Matrix3x3 const& b)
+{
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      PCU_ALWAYS_ASSERT(std::fabs(a[i][j] - b[i][j]) <=
+          1e-12 * (1 + std::fabs(b[i][j])));
+}
+
+/* cached factors match the computed ones, and the sides of each
+   element close up */
+static void checkCache(apf::Mesh* m)
+{
+  std::vector<Factors> expected = getAllFactors(m);
+  apf::cacheGeometry(m, true);
+  PCU_ALWAYS_ASSERT(apf::hasCachedGeometry(m));
+  std::vector<Factors> got = getAllFactors(m);
+  int dim = m->getDimension();
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  size_t i = 0;
+  while ((e = m->iterate(it))) {
+    same(got[i].J, expected[i].J);
+    same(got[i].Jinv, expected[i].Jinv);
+    PCU_ALWAYS_ASSERT(std::fabs(got[i].dv - expected[i].dv) <= 1e-12);
+    ++i;
+    apf::Vector3 c = apf::getLinearCentroid(m, e);
+    apf::Downward sides;
+    int n = m->getDownward(e, dim - 1, sides);
+    apf::Vector3 sum(0, 0, 0);
+    for (int s = 0; s < n; ++s) {
+      apf::Vector3 normal;
+      PCU_ALWAYS_ASSERT(apf::getCachedNormal(m, e, s, normal));
+      PCU_ALWAYS_ASSERT(std::fabs(normal.getLength() - 1) <= 1e-12);
+      PCU_ALWAYS_ASSERT(normal * (apf::getLinearCentroid(m, sides[s]) - c) > 0);
+      sum = sum + normal * apf::measure(m, sides[s]);
+    }
+    PCU_ALWAYS_ASSERT(sum.getLength() <= 1e-12);
+  }
+  m->end(it);
+}
+
+static double getVolume(apf::Mesh* m)
+{
+  double v = 0;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(m->getDimension());
+  while ((e = m->iterate(it)))
+    v += apf::measure(m, e);
+  m->end(it);
+  return v;
+}
+
+/* every change of coordinates or entities drops the cache */
+static void checkDrops(apf::Mesh2* m)
+{
+  apf::MeshEntity* v = apf::getMdsEntity(m, 0, 0);
+  apf::Vector3 x;
+  m->getPoint(v, 0, x);
+  apf::cacheGeometry(m);
+  PCU_ALWAYS_ASSERT(!apf::getCachedNormal(m, apf::getMdsEntity(m, 3, 0), 0, x));
+  m->setPoint(v, 0, x);
+  PCU_ALWAYS_ASSERT(!apf::hasCachedGeometry(m));
+  apf::cacheGeometry(m);
+  apf::Field* d = apf::createFieldOn(m, "d", apf::VECTOR);
+  apf::zeroField(d);
+  apf::displaceMesh(m, d);
+  PCU_ALWAYS_ASSERT(!apf::hasCachedGeometry(m));
+  apf::destroyField(d);
+  apf::cacheGeometry(m);
+  apf::reorderMdsMesh(m);
+  PCU_ALWAYS_ASSERT(!apf::hasCachedGeometry(m));
+  apf::cacheGeometry(m);
+  PCU_ALWAYS_ASSERT(std::fabs(getVolume(m) - 1) <= 1e-12);
+  apf::MeshEntity* tet = apf::getMdsEntity(m, 3, 0);
+  m->destroy(tet);
+  PCU_ALWAYS_ASSERT(!apf::hasCachedGeometry(m));
+  apf::changeMeshShape(m, apf::getLagrange(2));
+  apf::cacheGeometry(m);
+  PCU_ALWAYS_ASSERT(!apf::hasCachedGeometry(m));
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(0);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(3, 3, 3, 1, 1, 1, true, &PCUObj);
+  checkCache(m);
+  PCU_ALWAYS_ASSERT(std::fabs(getVolume(m) - 1) <= 1e-12);
+  checkDrops(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  m = apf::makeMdsBox(3, 4, 0, 2, 1, 0, true, &PCUObj);
+  checkCache(m);
+  PCU_ALWAYS_ASSERT(std::fabs(getVolume(m) - 2) <= 1e-12);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
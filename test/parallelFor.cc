@@ -0,0 +1,87 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <atomic>
+#include <mutex>
+#include <set>
+
+static void checkDimension(apf::Mesh2* m, int dim, int threads)
+{
+  std::atomic<int> count(0);
+  std::mutex mutex;
+  std::set<apf::MeshEntity*> seen;
+  apf::MeshTag* tag = m->findTag("number");
+  std::atomic<long> sum(0);
+  apf::parallelFor(m, dim, [&](apf::MeshEntity* e) {
+    ++count;
+    apf::Downward verts;
+    int nv = m->getDownward(e, 0, verts);
+    for (int i = 0; i < nv; ++i) {
+      int n;
+      m->getIntTag(verts[i], tag, &n);
+      sum += n;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    PCU_ALWAYS_ASSERT(!seen.count(e));
+    seen.insert(e);
+  }, threads);
+  PCU_ALWAYS_ASSERT(count == static_cast<int>(m->count(dim)));
+  long serial = 0;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(dim);
+  while ((e = m->iterate(it))) {
+    apf::Downward verts;
+    int nv = m->getDownward(e, 0, verts);
+    for (int i = 0; i < nv; ++i) {
+      int n;
+      m->getIntTag(verts[i], tag, &n);
+      serial += n;
+    }
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(sum == serial);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, &PCUObj);
+  apf::MeshTag* tag = m->createIntTag("number", 1);
+  int n = 0;
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    m->setIntTag(v, tag, &n);
+    ++n;
+  }
+  m->end(it);
+  /* leave gaps in the arrays, which ranges must skip */
+  it = m->begin(3);
+  for (int i = 0; i < 10; ++i)
+    m->destroy(m->iterate(it));
+  m->end(it);
+  for (int threads = 1; threads <= 4; ++threads)
+    for (int d = 0; d <= 3; ++d)
+      checkDimension(m, d, threads);
+  std::vector<apf::MdsRange> ranges;
+  apf::getMdsRanges(m, 3, 7, ranges);
+  size_t count = 0;
+  for (size_t i = 0; i < ranges.size(); ++i)
+    while (apf::iterateMdsRange(m, ranges[i]))
+      ++count;
+  PCU_ALWAYS_ASSERT(count == m->count(3));
+  apf::removeTagFromDimension(m, tag, 0);
+  m->destroyTag(tag);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
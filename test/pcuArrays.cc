@@ -0,0 +1,125 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* every rank sends i values to rank i, both sized and not */
+static void checkArrays(pcu::PCU& pcu)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  pcu.Begin();
+  for (int to = 0; to < peers; ++to) {
+    std::vector<double> d(to);
+    std::vector<long> l(to);
+    for (int i = 0; i < to; ++i) {
+      d[i] = self + i / 10.0;
+      l[i] = self * 100 + i;
+    }
+    pcu.PackSized(to, d.data(), d.size());
+    pcu.PackArray(to, l.data(), l.size());
+    pcu.Pack(to, self);
+  }
+  pcu.Send();
+  int got = 0;
+  while (pcu.Receive()) {
+    int from = pcu.Sender();
+    std::vector<double> d;
+    pcu.UnpackSized(d);
+    PCU_ALWAYS_ASSERT(d.size() == size_t(self));
+    std::vector<long> l(d.size());
+    pcu.UnpackArray(l.data(), l.size());
+    for (int i = 0; i < self; ++i) {
+      PCU_ALWAYS_ASSERT(d[i] == from + i / 10.0);
+      PCU_ALWAYS_ASSERT(l[i] == from * 100 + i);
+    }
+    int sender;
+    pcu.Unpack(sender);
+    PCU_ALWAYS_ASSERT(sender == from);
+    PCU_ALWAYS_ASSERT(pcu.Unpacked());
+    ++got;
+  }
+  PCU_ALWAYS_ASSERT(got == peers);
+}
+
+/* tags and remote copies travel through the array helpers */
+static void checkMigration(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  apf::MeshTag* it3 = m->createIntTag("ints", 3);
+  apf::MeshTag* dt2 = m->createDoubleTag("doubles", 2);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    int n[3] = {int(x.x() * 4), int(x.y() * 4), int(x.z() * 4)};
+    m->setIntTag(v, it3, n);
+    if (n[0] % 2) {
+      double d[2] = {x.y(), x.z()};
+      m->setDoubleTag(v, dt2, d);
+    }
+  }
+  m->end(it);
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    it = m->begin(3);
+    while ((e = m->iterate(it)))
+      if (apf::getLinearCentroid(m, e).x() > 0.5)
+        plan->send(e, 1);
+    m->end(it);
+  }
+  m->migrate(plan);
+  it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Vector3 x;
+    m->getPoint(v, 0, x);
+    int n[3];
+    m->getIntTag(v, it3, n);
+    PCU_ALWAYS_ASSERT(n[0] == int(x.x() * 4));
+    PCU_ALWAYS_ASSERT(n[1] == int(x.y() * 4));
+    PCU_ALWAYS_ASSERT(n[2] == int(x.z() * 4));
+    PCU_ALWAYS_ASSERT(m->hasTag(v, dt2) == bool(n[0] % 2));
+    if (n[0] % 2) {
+      double d[2];
+      m->getDoubleTag(v, dt2, d);
+      PCU_ALWAYS_ASSERT(d[0] == x.y() && d[1] == x.z());
+    }
+  }
+  m->end(it);
+  apf::verify(m);
+  apf::removeTagFromDimension(m, it3, 0);
+  apf::removeTagFromDimension(m, dt2, 0);
+  m->destroyTag(it3);
+  m->destroyTag(dt2);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  PCU_ALWAYS_ASSERT(PCUObj.Peers() == 2);
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  checkArrays(PCUObj);
+  checkMigration(&PCUObj);
+  }
+  pcu::Finalize();
+}
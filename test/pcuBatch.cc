@@ -0,0 +1,149 @@
+#include <PCU.h>
+#include <pcu_batch.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* every rank sends count records of growing sizes to every rank,
+   some larger than a chunk, which must arrive in packing order */
+static void exchange(pcu::PCU& pcu, size_t chunk, bool flush, int count)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  pcu::Batch batch(pcu, chunk, flush);
+  batch.Begin();
+  for (int i = 0; i < count; ++i)
+    for (int to = 0; to < peers; ++to) {
+      int n = (i * 7 + to) % 50;
+      int* r = static_cast<int*>(batch.Reserve(to, (n + 2) * sizeof(int)));
+      r[0] = self;
+      r[1] = i;
+      for (int j = 0; j < n; ++j)
+        r[j + 2] = self + i + j;
+    }
+  batch.Send();
+  std::vector<int> next(peers, 0);
+  while (batch.Receive()) {
+    int from = batch.Sender();
+    int head[2];
+    batch.Unpack(head);
+    PCU_ALWAYS_ASSERT(head[0] == from);
+    PCU_ALWAYS_ASSERT(head[1] == next[from]);
+    int i = next[from]++;
+    int n = (i * 7 + self) % 50;
+    PCU_ALWAYS_ASSERT(batch.Size() == (n + 2) * sizeof(int));
+    for (int j = 0; j < n; ++j) {
+      int v;
+      batch.Unpack(v);
+      PCU_ALWAYS_ASSERT(v == from + i + j);
+    }
+    PCU_ALWAYS_ASSERT(batch.Unpacked());
+  }
+  for (int from = 0; from < peers; ++from)
+    PCU_ALWAYS_ASSERT(next[from] == count);
+}
+
+/* records with no bytes and flushes of nothing */
+static void checkEmpty(pcu::PCU& pcu)
+{
+  int peers = pcu.Peers();
+  pcu::Batch batch(pcu, 16, true);
+  batch.Begin();
+  for (int to = 0; to < peers; ++to)
+    for (int i = 0; i < 20; ++i)
+      batch.Pack(to, nullptr, 0);
+  pcu.Flush((pcu.Self() + 1) % peers);
+  batch.Send();
+  int got = 0;
+  while (batch.Receive()) {
+    PCU_ALWAYS_ASSERT(!batch.Size());
+    ++got;
+  }
+  PCU_ALWAYS_ASSERT(got == 20 * peers);
+}
+
+static void checkMesh(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 c = apf::getLinearCentroid(m, e);
+      plan->send(e, ((c.x() > 0.5) + 2 * (c.y() > 0.5)) % pcu->Peers());
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  apf::Field* f = apf::createLagrangeField(m, "f", apf::VECTOR, 2);
+  apf::MeshEntity* e;
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it)))
+      apf::setVector(f, e, 0, apf::Vector3(1, m->isOwned(e), pcu->Self()));
+    m->end(it);
+  }
+  apf::synchronize(f);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 v;
+      apf::getVector(f, e, 0, v);
+      PCU_ALWAYS_ASSERT(v.y() == 1);
+      PCU_ALWAYS_ASSERT(v.z() == m->getOwner(e));
+    }
+    m->end(it);
+  }
+  apf::accumulate(f);
+  for (int d = 0; d <= 1; ++d) {
+    apf::MeshIterator* it = m->begin(d);
+    while ((e = m->iterate(it))) {
+      apf::Copies remotes;
+      m->getRemotes(e, remotes);
+      apf::Vector3 v;
+      apf::getVector(f, e, 0, v);
+      PCU_ALWAYS_ASSERT(v.x() == 1 + remotes.size());
+    }
+    m->end(it);
+  }
+  apf::destroyField(f);
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  for (int flush = 0; flush < 2; ++flush) {
+    exchange(PCUObj, 64, flush, 100);
+    exchange(PCUObj, 4096, flush, 100);
+    exchange(PCUObj, 1, flush, 10);
+  }
+  checkEmpty(PCUObj);
+  /* ordered phases ignore the flushes */
+  PCUObj.Order(true);
+  exchange(PCUObj, 64, true, 100);
+  PCUObj.Order(false);
+  checkMesh(&PCUObj);
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,104 @@
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+template <typename T>
+static void run(pcu::PCU& pcu, std::vector<T>& out)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  T v[3] = {T(self + 1), T(peers - self), T(self % 2)};
+  out.clear();
+  T a[3] = {v[0], v[1], v[2]};
+  pcu.Add(a, 3);
+  out.insert(out.end(), a, a + 3);
+  out.push_back(pcu.Min(v[1]));
+  out.push_back(pcu.Max(v[1]));
+  T s[3] = {v[0], v[1], v[2]};
+  pcu.Exscan(s, 3);
+  out.insert(out.end(), s, s + 3);
+  out.push_back(pcu.Exscan(v[0]));
+  std::vector<T> all(peers * 2);
+  pcu.Allgather(v, &all[0], 2);
+  out.insert(out.end(), all.begin(), all.end());
+}
+
+template <typename T>
+static void check(pcu::PCU& pcu)
+{
+  std::vector<T> tree;
+  std::vector<T> native;
+  pcu.NativeCollectives(false);
+  run(pcu, tree);
+  pcu.NativeCollectives(true);
+  run(pcu, native);
+  PCU_ALWAYS_ASSERT(tree == native);
+  int peers = pcu.Peers();
+  int self = pcu.Self();
+  PCU_ALWAYS_ASSERT(native[0] == T(peers * (peers + 1) / 2));
+  PCU_ALWAYS_ASSERT(native[3] == T(1));
+  PCU_ALWAYS_ASSERT(native[4] == T(peers));
+  PCU_ALWAYS_ASSERT(native[5] == T(self * (self + 1) / 2));
+  PCU_ALWAYS_ASSERT(native[8] == native[5]);
+  for (int i = 0; i < peers; ++i)
+    PCU_ALWAYS_ASSERT(native[9 + 2 * i] == T(i + 1));
+}
+
+/* starts several requests, runs blocking collectives
+   while they are pending and then checks their results */
+template <typename T>
+static void checkRequests(pcu::PCU& pcu, bool native)
+{
+  pcu.NativeCollectives(native);
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  T sum[2] = {T(self + 1), T(1)};
+  T max[1] = {T(self)};
+  T min[1] = {T(self + 2)};
+  T scan[2] = {T(self + 1), T(2)};
+  pcu::Request a = pcu.IAdd(sum, 2);
+  pcu::Request b = pcu.IMax(max, 1);
+  pcu::Request c = pcu.IExscan(scan, 2);
+  pcu::Request d = pcu.IMin(min, 1);
+  PCU_ALWAYS_ASSERT(pcu.Add<T>(T(1)) == T(peers));
+  pcu.Barrier();
+  while (!b.Test());
+  a.Wait();
+  d.Wait();
+  c.Wait();
+  PCU_ALWAYS_ASSERT(a.Test());
+  PCU_ALWAYS_ASSERT(sum[0] == T(peers * (peers + 1) / 2));
+  PCU_ALWAYS_ASSERT(sum[1] == T(peers));
+  PCU_ALWAYS_ASSERT(max[0] == T(peers - 1));
+  PCU_ALWAYS_ASSERT(min[0] == T(2));
+  PCU_ALWAYS_ASSERT(scan[0] == T(self * (self + 1) / 2));
+  PCU_ALWAYS_ASSERT(scan[1] == T(2 * self));
+  /* a pending request waits when it is destroyed */
+  {
+    pcu::Request e = pcu.IAdd(sum, 1);
+  }
+  PCU_ALWAYS_ASSERT(sum[0] == T(peers * peers * (peers + 1) / 2));
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  bool native = PCUObj.NativeCollectives();
+  check<int>(PCUObj);
+  check<long>(PCUObj);
+  check<size_t>(PCUObj);
+  check<double>(PCUObj);
+  for (int mode = 0; mode < 2; ++mode) {
+    checkRequests<int>(PCUObj, mode);
+    checkRequests<long>(PCUObj, mode);
+    checkRequests<size_t>(PCUObj, mode);
+    checkRequests<double>(PCUObj, mode);
+  }
+  PCUObj.NativeCollectives(native);
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,97 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstring>
+
+/* every rank sends n ints to each other rank, counting
+   only the first `counted` of them ahead of time */
+static void exchange(pcu::PCU& pcu, int n, int counted, bool reserve)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  pcu.Begin();
+  for (int to = 0; to < peers; ++to)
+    if (to != self)
+      pcu.Count(to, counted * sizeof(int));
+  for (int i = 0; i < n; ++i)
+    for (int to = 0; to < peers; ++to) {
+      if (to == self)
+        continue;
+      int v = self * 1000 + i;
+      if (reserve)
+        memcpy(pcu.Reserve(to, sizeof(v)), &v, sizeof(v));
+      else
+        pcu.Pack(to, v);
+    }
+  pcu.Send();
+  int got = 0;
+  while (pcu.Receive()) {
+    int from = pcu.Sender();
+    PCU_ALWAYS_ASSERT(from != self);
+    for (int i = 0; i < n; ++i) {
+      int v;
+      pcu.Unpack(v);
+      PCU_ALWAYS_ASSERT(v == from * 1000 + i);
+    }
+    PCU_ALWAYS_ASSERT(pcu.Unpacked());
+    ++got;
+  }
+  PCU_ALWAYS_ASSERT(got == (n ? peers - 1 : 0));
+}
+
+static void checkMigration(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 c = apf::getLinearCentroid(m, e);
+      plan->send(e, (c.x() > 0.5) + 2 * (c.y() > 0.5));
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  PCU_ALWAYS_ASSERT(pcu->Add<long>(m->count(3)) == 6 * 4 * 4 * 4);
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  PCU_ALWAYS_ASSERT(PCUObj.Peers() == 4);
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  /* exact counts, growing counts that reuse the arena,
+     overflowing counts and counts that are never packed */
+  for (int round = 0; round < 2; ++round) {
+    bool reserve = round;
+    exchange(PCUObj, 10, 10, reserve);
+    exchange(PCUObj, 10, 10, reserve);
+    exchange(PCUObj, 100, 100, reserve);
+    exchange(PCUObj, 100, 20, reserve);
+    exchange(PCUObj, 30, 0, reserve);
+    exchange(PCUObj, 0, 5, reserve);
+  }
+  checkMigration(&PCUObj);
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,137 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* every rank sends to every other rank whose sum with it is not
+   a multiple of three, including itself, and some messages are empty */
+static void exchange(pcu::PCU& pcu, int n, bool ordered)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  pcu.Order(ordered);
+  pcu.Begin();
+  int expected = 0;
+  for (int to = 0; to < peers; ++to) {
+    if ((self + to) % 3 == 0)
+      continue;
+    std::vector<int> v(n + to);
+    for (size_t i = 0; i < v.size(); ++i)
+      v[i] = self * 1000 + i;
+    pcu.PackSized(to, v.data(), v.size());
+  }
+  for (int from = 0; from < peers; ++from)
+    if ((from + self) % 3)
+      ++expected;
+  pcu.Send();
+  int got = 0;
+  int last = -1;
+  while (pcu.Receive()) {
+    int from = pcu.Sender();
+    PCU_ALWAYS_ASSERT((from + self) % 3);
+    if (ordered)
+      PCU_ALWAYS_ASSERT(from > last);
+    last = from;
+    std::vector<int> v;
+    pcu.UnpackSized(v);
+    PCU_ALWAYS_ASSERT(v.size() == size_t(n + self));
+    for (size_t i = 0; i < v.size(); ++i)
+      PCU_ALWAYS_ASSERT(v[i] == from * 1000 + int(i));
+    ++got;
+  }
+  PCU_ALWAYS_ASSERT(got == expected);
+  pcu.Order(false);
+}
+
+static void checkCollectives(pcu::PCU& pcu)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  bool native = pcu.NativeCollectives();
+  pcu.NativeCollectives(true);
+  double v[3] = {double(self), double(peers - self), 1.0};
+  pcu.Add(v, 3);
+  PCU_ALWAYS_ASSERT(v[0] == peers * (peers - 1) / 2);
+  PCU_ALWAYS_ASSERT(v[1] == peers * (peers + 1) / 2);
+  PCU_ALWAYS_ASSERT(v[2] == peers);
+  PCU_ALWAYS_ASSERT(pcu.Min<int>(self + 3) == 3);
+  PCU_ALWAYS_ASSERT(pcu.Max<long>(self) == peers - 1);
+  PCU_ALWAYS_ASSERT(pcu.Add<size_t>(2) == size_t(2 * peers));
+  PCU_ALWAYS_ASSERT(pcu.Exscan<int>(1) == self);
+  pcu.NativeCollectives(native);
+}
+
+static void checkMesh(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 c = apf::getLinearCentroid(m, e);
+      plan->send(e, ((c.x() > 0.5) + 2 * (c.y() > 0.5)) % pcu->Peers());
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  apf::Field* f = apf::createLagrangeField(m, "f", apf::SCALAR, 1);
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it)))
+    apf::setScalar(f, v, 0, 1);
+  m->end(it);
+  apf::accumulate(f);
+  it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Copies remotes;
+    m->getRemotes(v, remotes);
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == 1 + remotes.size());
+  }
+  m->end(it);
+  apf::destroyField(f);
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  /* shared memory nodes, then one, two and three ranks per node */
+  for (int size = 0; size <= 3; ++size) {
+    PCUObj.Hierarchy(true, size);
+    for (int n = 0; n < 20; n += 7) {
+      exchange(PCUObj, n, false);
+      exchange(PCUObj, n, true);
+    }
+    checkCollectives(PCUObj);
+    checkMesh(&PCUObj);
+  }
+  /* the messages on one node may also use its shared memory */
+  PCUObj.SharedMemory(64);
+  exchange(PCUObj, 10, false);
+  PCUObj.SharedMemory(0);
+  PCUObj.Hierarchy(false);
+  exchange(PCUObj, 10, true);
+  checkCollectives(PCUObj);
+  }
+  pcu::Finalize();
+}
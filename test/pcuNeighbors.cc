@@ -0,0 +1,117 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfNumbering.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+/* each rank sends its rank to both sides of a ring
+   and, on even phases, to itself */
+static void exchange(pcu::PCU& pcu, int phase)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  int left = (self + peers - 1) % peers;
+  int right = (self + 1) % peers;
+  pcu.Begin();
+  int msg[2] = {self, phase};
+  pcu.Pack(left, msg);
+  if (right != left)
+    pcu.Pack(right, msg);
+  if (!(phase % 2))
+    pcu.Pack(self, msg);
+  pcu.Send();
+  int got = 0;
+  while (pcu.Receive()) {
+    pcu.Unpack(msg);
+    PCU_ALWAYS_ASSERT(msg[0] == pcu.Sender());
+    PCU_ALWAYS_ASSERT(msg[1] == phase);
+    ++got;
+  }
+  int expected = (right != left) ? 2 : 1;
+  if (!(phase % 2))
+    ++expected;
+  PCU_ALWAYS_ASSERT(got == expected);
+}
+
+static void checkRing(pcu::PCU& pcu)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  int ring[2] = {(self + peers - 1) % peers, (self + 1) % peers};
+  pcu.Neighbors(ring, 2);
+  for (int i = 0; i < 10; ++i)
+    exchange(pcu, i);
+  pcu.Order(true);
+  for (int i = 10; i < 20; ++i)
+    exchange(pcu, i);
+  pcu.Order(false);
+  pcu.Neighbors(nullptr, 0);
+  for (int i = 20; i < 30; ++i)
+    exchange(pcu, i);
+}
+
+static void checkMesh(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  /* keep the box on rank 0 only, then move its upper half to rank 1 */
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it)))
+      if (apf::getLinearCentroid(m, e).x() > 0.5)
+        plan->send(e, 1);
+    m->end(it);
+  }
+  m->migrate(plan);
+  apf::setPCUNeighbors(m);
+  apf::Field* f = apf::createLagrangeField(m, "f", apf::SCALAR, 1);
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it)))
+    apf::setScalar(f, v, 0, m->isOwned(v) ? 1 : 0);
+  m->end(it);
+  apf::synchronize(f);
+  it = m->begin(0);
+  while ((v = m->iterate(it)))
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == 1);
+  m->end(it);
+  apf::accumulate(f);
+  it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Copies remotes;
+    m->getRemotes(v, remotes);
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == 1 + remotes.size());
+  }
+  m->end(it);
+  apf::clearPCUNeighbors(m);
+  apf::destroyField(f);
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  checkRing(PCUObj);
+  checkMesh(&PCUObj);
+  }
+  pcu::Finalize();
+}
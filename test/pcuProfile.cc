@@ -0,0 +1,92 @@
+#include <PCU.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/* every rank sends n bytes to each side of a ring */
+static void ring(pcu::PCU& pcu, const char* label, int n)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  if (label)
+    pcu.Begin(label);
+  else
+    pcu.Begin();
+  std::string s(n, 'x');
+  pcu.PackSized((self + 1) % peers, s.data(), s.size());
+  pcu.PackSized((self + peers - 1) % peers, s.data(), s.size());
+  pcu.Send();
+  while (pcu.Receive()) {
+    std::vector<char> v;
+    while (!pcu.Unpacked())
+      pcu.UnpackSized(v);
+  }
+}
+
+static std::string readFile(const char* path)
+{
+  std::ifstream f(path);
+  PCU_ALWAYS_ASSERT(f.good());
+  std::stringstream s;
+  s << f.rdbuf();
+  return s.str();
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  PCU_ALWAYS_ASSERT(PCUObj.Peers() == 4);
+  lion_set_verbosity(1);
+  PCUObj.Profile("pcuProfile");
+  for (int i = 0; i < 3; ++i)
+    ring(PCUObj, "ring \"small\"", 10);
+  ring(PCUObj, "ring large", 1000);
+  ring(PCUObj, nullptr, 5);
+  PCUObj.Order(false);
+  ring(PCUObj, "ring large", 1000);
+  PCUObj.Order(true);
+  int ranks[2] = {(PCUObj.Self() + 1) % 4, (PCUObj.Self() + 3) % 4};
+  PCUObj.Neighbors(ranks, 2);
+  ring(PCUObj, "neighbors", 10);
+  PCUObj.Neighbors(nullptr, 0);
+  PCUObj.Profile(nullptr);
+  /* not profiled */
+  ring(PCUObj, "ring \"small\"", 10);
+  if (!PCUObj.Self()) {
+    std::string csv = readFile("pcuProfile.csv");
+    std::string header = "rank,label,phases,wall,wait,sent_bytes,"
+      "sent_messages,received_bytes,received_messages,max_peers\n";
+    PCU_ALWAYS_ASSERT(csv.compare(0, header.size(), header) == 0);
+    /* a header and four ranks of four labels */
+    size_t lines = 0;
+    for (size_t i = 0; i < csv.size(); ++i)
+      lines += csv[i] == '\n';
+    PCU_ALWAYS_ASSERT(lines == 1 + 4 * 4);
+    /* each message holds its length and the bytes */
+    size_t bytes = 2 * (sizeof(size_t) + 10) * 3;
+    std::stringstream row;
+    row << "0,\"ring \"\"small\"\"\",3,";
+    PCU_ALWAYS_ASSERT(csv.find(row.str()) != std::string::npos);
+    std::stringstream sent;
+    sent << ',' << bytes << ",6," << bytes << ",6,2\n";
+    PCU_ALWAYS_ASSERT(csv.find(sent.str()) != std::string::npos);
+    std::string json = readFile("pcuProfile.json");
+    PCU_ALWAYS_ASSERT(json.find("\"ranks\": 4") != std::string::npos);
+    PCU_ALWAYS_ASSERT(json.find("\"label\": \"ring \\\"small\\\"\"")
+        != std::string::npos);
+    PCU_ALWAYS_ASSERT(json.find("\"label\": \"neighbors\"")
+        != std::string::npos);
+    PCU_ALWAYS_ASSERT(json.find("\"phases\": "
+          "{\"min\": 2, \"max\": 2, \"avg\": 2}") != std::string::npos);
+    std::remove("pcuProfile.csv");
+    std::remove("pcuProfile.json");
+  }
+  }
+  pcu::Finalize();
+}
@@ -0,0 +1,148 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+/* every rank sends n + to ints to every rank, so that
+   some messages fit in the slots and some do not */
+static void exchange(pcu::PCU& pcu, int n)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  pcu.Begin();
+  for (int to = 0; to < peers; ++to) {
+    std::vector<int> v(n + to);
+    for (size_t i = 0; i < v.size(); ++i)
+      v[i] = self * 1000 + i;
+    pcu.PackSized(to, v.data(), v.size());
+  }
+  pcu.Send();
+  int got = 0;
+  while (pcu.Receive()) {
+    int from = pcu.Sender();
+    std::vector<int> v;
+    pcu.UnpackSized(v);
+    PCU_ALWAYS_ASSERT(v.size() == size_t(n + self));
+    for (size_t i = 0; i < v.size(); ++i)
+      PCU_ALWAYS_ASSERT(v[i] == from * 1000 + int(i));
+    ++got;
+  }
+  PCU_ALWAYS_ASSERT(got == peers);
+}
+
+static void checkRing(pcu::PCU& pcu)
+{
+  int self = pcu.Self();
+  int peers = pcu.Peers();
+  int ring[2] = {(self + peers - 1) % peers, (self + 1) % peers};
+  pcu.Neighbors(ring, 2);
+  for (int phase = 0; phase < 20; ++phase) {
+    pcu.Begin();
+    std::vector<int> v(phase, self);
+    pcu.PackSized(ring[0], v.data(), v.size());
+    if (ring[1] != ring[0])
+      pcu.PackSized(ring[1], v.data(), v.size());
+    pcu.Send();
+    int got = 0;
+    while (pcu.Receive()) {
+      pcu.UnpackSized(v);
+      PCU_ALWAYS_ASSERT(v.size() == size_t(phase));
+      PCU_ALWAYS_ASSERT(!phase || v[0] == pcu.Sender());
+      ++got;
+    }
+    PCU_ALWAYS_ASSERT(got == (ring[0] == ring[1] ? 1 : 2));
+  }
+  pcu.Neighbors(nullptr, 0);
+}
+
+/* pending requests must not hold up the collectives
+   started after them, whichever transport they use */
+static void checkCollectives(pcu::PCU& pcu)
+{
+  int peers = pcu.Peers();
+  bool native = pcu.NativeCollectives();
+  pcu.NativeCollectives(false);
+  for (int n = 1; n <= 32; n *= 2) {
+    std::vector<long> a(n, 1);
+    std::vector<long> b(n, 2);
+    pcu::Request r = pcu.IAdd(a.data(), a.size());
+    pcu.Max(b.data(), b.size());
+    PCU_ALWAYS_ASSERT(pcu.Add<int>(1) == peers);
+    r.Wait();
+    for (int i = 0; i < n; ++i) {
+      PCU_ALWAYS_ASSERT(a[i] == peers);
+      PCU_ALWAYS_ASSERT(b[i] == 2);
+    }
+  }
+  pcu.NativeCollectives(native);
+}
+
+static void checkMesh(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 c = apf::getLinearCentroid(m, e);
+      plan->send(e, ((c.x() > 0.5) + 2 * (c.y() > 0.5)) % pcu->Peers());
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  apf::Field* f = apf::createLagrangeField(m, "f", apf::SCALAR, 1);
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it)))
+    apf::setScalar(f, v, 0, 1);
+  m->end(it);
+  apf::accumulate(f);
+  it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Copies remotes;
+    m->getRemotes(v, remotes);
+    PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == 1 + remotes.size());
+  }
+  m->end(it);
+  apf::destroyField(f);
+  apf::verify(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  /* slots of 64 bytes take about half of the messages below */
+  PCUObj.SharedMemory(64);
+  for (int n = 0; n < 32; n += 3)
+    exchange(PCUObj, n);
+  checkRing(PCUObj);
+  checkCollectives(PCUObj);
+  checkMesh(&PCUObj);
+  PCUObj.SharedMemory(1 << 16);
+  checkMesh(&PCUObj);
+  PCUObj.SharedMemory(0);
+  exchange(PCUObj, 10);
+  checkCollectives(PCUObj);
+  }
+  pcu::Finalize();
+}
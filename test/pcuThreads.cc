@@ -0,0 +1,154 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* every rank sends tag-marked ints to every rank,
+   then checks some collectives */
+static void exchange(pcu::PCU* pcu, int tag)
+{
+  int self = pcu->Self();
+  int peers = pcu->Peers();
+  for (int phase = 0; phase < 50; ++phase) {
+    pcu->Begin();
+    for (int to = 0; to < peers; ++to) {
+      int msg[3] = {tag, phase, self};
+      pcu->Pack(to, msg);
+    }
+    pcu->Send();
+    int got = 0;
+    while (pcu->Receive()) {
+      int msg[3];
+      pcu->Unpack(msg);
+      PCU_ALWAYS_ASSERT(msg[0] == tag);
+      PCU_ALWAYS_ASSERT(msg[1] == phase);
+      PCU_ALWAYS_ASSERT(msg[2] == pcu->Sender());
+      ++got;
+    }
+    PCU_ALWAYS_ASSERT(got == peers);
+    PCU_ALWAYS_ASSERT(pcu->Add<int>(tag) == tag * peers);
+    PCU_ALWAYS_ASSERT(pcu->Max<int>(self + tag) == peers - 1 + tag);
+  }
+  pcu->DebugOpen();
+  pcu->DebugPrint("tag %d\n", tag);
+}
+
+static apf::Mesh2* makeMesh(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 c = apf::getLinearCentroid(m, e);
+      plan->send(e, ((c.x() > 0.5) + 2 * (c.y() > 0.5)) % pcu->Peers());
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  return m;
+}
+
+static void accumulate(apf::Mesh2* m)
+{
+  apf::Field* f = apf::createLagrangeField(m, "f", apf::SCALAR, 1);
+  for (int i = 0; i < 10; ++i) {
+    apf::MeshEntity* v;
+    apf::MeshIterator* it = m->begin(0);
+    while ((v = m->iterate(it)))
+      apf::setScalar(f, v, 0, 1);
+    m->end(it);
+    apf::accumulate(f);
+    it = m->begin(0);
+    while ((v = m->iterate(it))) {
+      apf::Copies remotes;
+      m->getRemotes(v, remotes);
+      PCU_ALWAYS_ASSERT(apf::getScalar(f, v, 0) == 1 + remotes.size());
+    }
+    m->end(it);
+  }
+  apf::destroyField(f);
+}
+
+static void verify(apf::Mesh2* m)
+{
+  for (int i = 0; i < 5; ++i)
+    apf::verify(m);
+}
+
+static void checkDebugFile(pcu::PCU& pcu, int thread, int tag)
+{
+  std::string path = "debug";
+  if (thread)
+    path += "-t" + std::to_string(thread) + "-";
+  path += std::to_string(pcu.Self()) + ".txt";
+  FILE* f = fopen(path.c_str(), "r");
+  PCU_ALWAYS_ASSERT(f);
+  int got = -1;
+  PCU_ALWAYS_ASSERT(fscanf(f, "tag %d", &got) == 1);
+  fclose(f);
+  remove(path.c_str());
+  PCU_ALWAYS_ASSERT(got == tag);
+}
+
+int main(int argc, char** argv)
+{
+  pcu::InitThreads(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(0);
+  gmi_register_mesh();
+  /* every object is made here, in the same order on all ranks */
+  std::unique_ptr<pcu::PCU> a = PCUObj.Dup();
+  std::unique_ptr<pcu::PCU> b = PCUObj.Dup();
+  std::unique_ptr<pcu::PCU> c = PCUObj.Dup();
+  std::unique_ptr<pcu::PCU> d = PCUObj.Dup();
+  apf::Mesh2* ma = makeMesh(c.get());
+  apf::Mesh2* mb = makeMesh(d.get());
+  if (pcu::MultipleThreads()) {
+    std::thread ta(exchange, a.get(), 1);
+    ta.join();
+    /* the thread above came first, so it was numbered 1 */
+    std::vector<std::thread> threads;
+    threads.emplace_back(exchange, b.get(), 2);
+    threads.emplace_back(accumulate, ma);
+    threads.emplace_back(verify, mb);
+    exchange(&PCUObj, 3);
+    for (size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+    checkDebugFile(PCUObj, 1, 1);
+    checkDebugFile(PCUObj, 2, 2);
+    checkDebugFile(PCUObj, 0, 3);
+  } else {
+    if (!PCUObj.Self())
+      fprintf(stderr, "MPI_THREAD_MULTIPLE is not provided, "
+          "running the threads one after the other\n");
+    exchange(b.get(), 2);
+    accumulate(ma);
+    verify(mb);
+    checkDebugFile(PCUObj, 0, 2);
+  }
+  ma->destroyNative();
+  apf::destroyMesh(ma);
+  mb->destroyNative();
+  apf::destroyMesh(mb);
+  }
+  pcu::Finalize();
+}
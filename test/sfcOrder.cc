@@ -0,0 +1,68 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(8, 8, 8, 1, 2, 3, true, &PCUObj);
+  size_t counts[4];
+  for (int d = 0; d < 4; ++d)
+    counts[d] = m->count(d);
+  apf::MdsOrder orders[3] = {apf::MDS_ORDER_BFS,
+    apf::MDS_ORDER_HILBERT, apf::MDS_ORDER_MORTON};
+  apf::Field* x = apf::createFieldOn(m, "x", apf::VECTOR);
+  apf::Field* y = apf::createFieldOn(m, "y", apf::SCALAR);
+  apf::MeshEntity* v;
+  apf::MeshIterator* it = m->begin(0);
+  while ((v = m->iterate(it))) {
+    apf::Vector3 p;
+    m->getPoint(v, 0, p);
+    apf::setVector(x, v, 0, p);
+    apf::setScalar(y, v, 0, p[2]);
+  }
+  m->end(it);
+  apf::freeze(x);
+  apf::freeze(y);
+  double* xa = apf::getArrayData(x);
+  double* ya = apf::getArrayData(y);
+  double misses[3];
+  for (int i = 0; i < 3; ++i) {
+    apf::reorderMdsMesh(m, orders[i]);
+    apf::verify(m);
+    for (int d = 0; d < 4; ++d)
+      PCU_ALWAYS_ASSERT(m->count(d) == counts[d]);
+    apf::MdsOrderQuality q = apf::measureMdsOrder(m);
+    PCU_ALWAYS_ASSERT(q.bandwidth > 0);
+    PCU_ALWAYS_ASSERT(q.meanBandwidth <= q.bandwidth);
+    PCU_ALWAYS_ASSERT(q.missesPerElement > 0);
+    PCU_ALWAYS_ASSERT(q.missesPerElement <= 4);
+    misses[i] = q.missesPerElement;
+    /* frozen arrays follow the new vertex order */
+    PCU_ALWAYS_ASSERT(apf::isFrozen(x) && apf::getArrayData(x) == xa);
+    PCU_ALWAYS_ASSERT(apf::getArrayData(y) == ya);
+    for (size_t j = 0; j < counts[0]; ++j) {
+      apf::Vector3 p;
+      m->getPoint(apf::getMdsEntity(m, 0, j), 0, p);
+      for (int k = 0; k < 3; ++k)
+        PCU_ALWAYS_ASSERT(xa[3 * j + k] == p[k]);
+      PCU_ALWAYS_ASSERT(ya[j] == p[2]);
+    }
+  }
+  /* the curves exist for the sake of element locality */
+  PCU_ALWAYS_ASSERT(misses[1] <= misses[0]);
+  apf::destroyField(x);
+  apf::destroyField(y);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
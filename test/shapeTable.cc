@@ -0,0 +1,121 @@
+#include <PCU.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <apfShape.h>
+#include <apfElement.h>
+#include <apfShapeTable.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cmath>
+
+static double const tolerance = 1e-12;
+
+static void close(apf::Vector3 const& a, apf::Vector3 const& b)
+{
+  PCU_ALWAYS_ASSERT((a - b).getLength() <= tolerance * (1 + b.getLength()));
+}
+
+/* evaluations at the integration points read the tables and must
+   match evaluations that bypass them */
+static void checkField(apf::Mesh* m, apf::FieldShape* s, int order,
+    bool grads = true)
+{
+  apf::Field* f = apf::createField(m, "f", apf::SCALAR, s);
+  apf::zeroField(f);
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(3);
+  while ((e = m->iterate(it))) {
+    apf::MeshElement* me = apf::createMeshElement(m, e);
+    apf::Element* el = apf::createElement(f, me);
+    apf::EntityShape* es = el->getShape();
+    int np = apf::countIntPoints(me, order);
+    for (int p = 0; p < np; ++p) {
+      apf::Vector3 xi;
+      apf::getIntPoint(me, order, p, xi);
+      if (s->isVectorShape()) {
+        apf::NewArray<apf::Vector3> a, b;
+        el->getVectorValues(xi, a);
+        es->getVectorValues(m, e, xi, b);
+        for (size_t i = 0; i < b.size(); ++i)
+          close(a[i], b[i]);
+        el->getLocalVectorCurls(xi, a);
+        es->getLocalVectorCurls(m, e, xi, b);
+        for (size_t i = 0; i < b.size(); ++i)
+          close(a[i], b[i]);
+      } else {
+        apf::NewArray<double> a, b;
+        el->getShapeValues(xi, a);
+        es->getValues(m, e, xi, b);
+        for (size_t i = 0; i < b.size(); ++i)
+          PCU_ALWAYS_ASSERT(std::fabs(a[i] - b[i]) <= tolerance);
+        if (grads) {
+          apf::NewArray<apf::Vector3> ga, gb;
+          el->getLocalGradients(xi, ga);
+          es->getLocalGradients(m, e, xi, gb);
+          for (size_t i = 0; i < gb.size(); ++i)
+            close(ga[i], gb[i]);
+        }
+      }
+      apf::Matrix3x3 J;
+      apf::getJacobian(me, xi, J);
+      PCU_ALWAYS_ASSERT(std::fabs(apf::getJacobianDeterminant(J, 3) -
+            apf::getDV(me, xi)) <= tolerance);
+    }
+    apf::destroyElement(el);
+    apf::destroyMeshElement(me);
+  }
+  m->end(it);
+  apf::destroyField(f);
+}
+
+/* Element volumes summed through the Integrator, which tabulates
+   the coordinate shape */
+static void checkMeasure(apf::Mesh* m)
+{
+  double v = 0;
+  apf::MeshEntity* e;
+  apf::MeshIterator* it = m->begin(3);
+  while ((e = m->iterate(it))) {
+    apf::MeshElement* me = apf::createMeshElement(m, e);
+    v += apf::measure(me);
+    apf::destroyMeshElement(me);
+  }
+  m->end(it);
+  PCU_ALWAYS_ASSERT(std::fabs(v - 1) <= tolerance);
+}
+
+static void checkShapes()
+{
+  PCU_ALWAYS_ASSERT(apf::getLagrange(2)->canTabulate());
+  PCU_ALWAYS_ASSERT(apf::getNedelec(3)->canTabulate());
+  /* hierarchic shapes depend on edge orientations */
+  PCU_ALWAYS_ASSERT(!apf::getHierarchic(2)->canTabulate());
+  PCU_ALWAYS_ASSERT(!apf::getShapeTable(apf::getHierarchic(2),
+        apf::Mesh::TET, 0, apf::ShapeTable::VALUES));
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(2, 2, 2, 1, 1, 1, true, &PCUObj);
+  checkShapes();
+  checkField(m, apf::getLagrange(1), 2);
+  checkField(m, apf::getLagrange(2), 4);
+  /* H1 shapes have no gradients yet */
+  checkField(m, apf::getH1Shape(3), 6, false);
+  checkField(m, apf::getNedelec(2), 4);
+  checkField(m, apf::getNedelec(3), 6);
+  checkField(m, apf::getHierarchic(2), 4);
+  checkMeasure(m);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
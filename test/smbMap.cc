@@ -0,0 +1,74 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionCompress.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+
+static void compare(apf::Mesh2* a, apf::Mesh2* b)
+{
+  apf::MeshTag* ta = a->findTag("number");
+  apf::MeshTag* tb = b->findTag("number");
+  PCU_ALWAYS_ASSERT(tb);
+  for (int d = 0; d <= 3; ++d) {
+    PCU_ALWAYS_ASSERT(a->count(d) == b->count(d));
+    for (size_t i = 0; i < a->count(d); ++i) {
+      apf::MeshEntity* ea = apf::getMdsEntity(a, d, i);
+      apf::MeshEntity* eb = apf::getMdsEntity(b, d, i);
+      PCU_ALWAYS_ASSERT(a->getType(ea) == b->getType(eb));
+      PCU_ALWAYS_ASSERT(a->toModel(ea) == b->toModel(eb));
+      apf::Downward da, db;
+      int n = a->getDownward(ea, 0, da);
+      PCU_ALWAYS_ASSERT(n == b->getDownward(eb, 0, db));
+      for (int j = 0; j < n; ++j)
+        PCU_ALWAYS_ASSERT(apf::getMdsIndex(a, da[j]) ==
+            apf::getMdsIndex(b, db[j]));
+      if (d < 3)
+        PCU_ALWAYS_ASSERT(a->countUpward(ea) == b->countUpward(eb));
+      if (d == 0) {
+        apf::Vector3 xa, xb;
+        a->getPoint(ea, 0, xa);
+        b->getPoint(eb, 0, xb);
+        PCU_ALWAYS_ASSERT((xa - xb).getLength() == 0);
+        int va, vb;
+        a->getIntTag(ea, ta, &va);
+        b->getIntTag(eb, tb, &vb);
+        PCU_ALWAYS_ASSERT(va == vb);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(3, 3, 3, 1, 1, 1, true, &PCUObj);
+  apf::MeshTag* tag = m->createIntTag("number", 1);
+  for (size_t i = 0; i < m->count(0); ++i) {
+    int n = i * 7;
+    m->setIntTag(apf::getMdsEntity(m, 0, i), tag, &n);
+  }
+  const char* paths[2] = {"smbMap.smb", "zip:smbMapZip.smb"};
+  for (int i = 0; i < 2; ++i) {
+    if (i && !lion::can_compress)
+      continue;
+    m->writeNative(paths[i]);
+    apf::Mesh2* m2 = apf::loadMdsMesh(m->getModel(), paths[i], &PCUObj);
+    apf::disownMdsModel(m2);
+    compare(m, m2);
+    m2->destroyNative();
+    apf::destroyMesh(m2);
+  }
+  apf::removeTagFromDimension(m, tag, 0);
+  m->destroyTag(tag);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
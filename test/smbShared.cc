@@ -0,0 +1,134 @@
+#include <PCU.h>
+#include <pcu_io.h>
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionCompress.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static bool exists(const char* path)
+{
+  FILE* f = fopen(path, "r");
+  if (f)
+    fclose(f);
+  return f != nullptr;
+}
+
+/* two shared files of interleaved ranks, some parts empty */
+static void checkParts(pcu::PCU& pcu)
+{
+  int self = pcu.Self();
+  int file = self % 2;
+  std::string path = "smbSharedParts" + std::to_string(file) + ".bin";
+  std::vector<unsigned> v(self % 3 ? 1000 * self : 0);
+  for (size_t i = 0; i < v.size(); ++i)
+    v[i] = self + i;
+  pcu_file* f = pcu_fopen_shared(pcu.GetCHandle(), path.c_str(), file,
+      true, false);
+  pcu_write_unsigneds(f, v.data(), v.size());
+  pcu_fclose(f);
+  pcu.Barrier();
+  if (!self)
+    PCU_ALWAYS_ASSERT(!exists("smbSharedParts2.bin"));
+  f = pcu_fopen_shared(pcu.GetCHandle(), path.c_str(), file, false, false);
+  size_t size;
+  void* p = pcu_fmap(f, &size);
+  PCU_ALWAYS_ASSERT(size == v.size() * sizeof(unsigned));
+  std::vector<unsigned> w(v.size());
+  pcu_read_unsigneds(f, w.data(), w.size());
+  PCU_ALWAYS_ASSERT(v == w);
+  pcu_funmap(f, p, size);
+  pcu_fclose(f);
+  pcu.Barrier();
+  if (!self) {
+    remove("smbSharedParts0.bin");
+    remove("smbSharedParts1.bin");
+  }
+}
+
+static apf::Mesh2* makeMesh(pcu::PCU* pcu)
+{
+  apf::Mesh2* m = apf::makeMdsBox(4, 4, 4, 1, 1, 1, true, pcu);
+  if (pcu->Self())
+    for (int d = 3; d >= 0; --d) {
+      apf::MeshEntity* e;
+      apf::MeshIterator* it = m->begin(d);
+      while ((e = m->iterate(it)))
+        m->destroy(e);
+      m->end(it);
+    }
+  apf::Migration* plan = new apf::Migration(m);
+  if (!pcu->Self()) {
+    apf::MeshEntity* e;
+    apf::MeshIterator* it = m->begin(3);
+    while ((e = m->iterate(it))) {
+      apf::Vector3 c = apf::getLinearCentroid(m, e);
+      plan->send(e, ((c.x() > 0.5) + 2 * (c.y() > 0.5)) % pcu->Peers());
+    }
+    m->end(it);
+  }
+  m->migrate(plan);
+  apf::reorderMdsMesh(m);
+  return m;
+}
+
+static void compare(apf::Mesh2* a, apf::Mesh2* b)
+{
+  for (int d = 0; d <= 3; ++d) {
+    PCU_ALWAYS_ASSERT(a->count(d) == b->count(d));
+    for (size_t i = 0; i < a->count(d); ++i) {
+      apf::MeshEntity* ea = apf::getMdsEntity(a, d, i);
+      apf::MeshEntity* eb = apf::getMdsEntity(b, d, i);
+      PCU_ALWAYS_ASSERT(a->toModel(ea) == b->toModel(eb));
+      apf::Copies ra, rb;
+      a->getRemotes(ea, ra);
+      b->getRemotes(eb, rb);
+      PCU_ALWAYS_ASSERT(ra.size() == rb.size());
+      if (d == 0) {
+        apf::Vector3 xa, xb;
+        a->getPoint(ea, 0, xa);
+        b->getPoint(eb, 0, xb);
+        PCU_ALWAYS_ASSERT((xa - xb).getLength() == 0);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  checkParts(PCUObj);
+  apf::Mesh2* m = makeMesh(&PCUObj);
+  const char* paths[2] = {"smbShared.psmb", "zip:smbSharedZip.psmb"};
+  const char* files[2] = {"smbShared.psmb", "smbSharedZip.psmb"};
+  for (int i = 0; i < 2; ++i) {
+    if (i && !lion::can_compress)
+      continue;
+    m->writeNative(paths[i]);
+    PCUObj.Barrier();
+    PCU_ALWAYS_ASSERT(exists(files[i]));
+    apf::Mesh2* m2 = apf::loadMdsMesh(m->getModel(), paths[i], &PCUObj);
+    apf::disownMdsModel(m2);
+    compare(m, m2);
+    apf::verify(m2);
+    m2->destroyNative();
+    apf::destroyMesh(m2);
+    PCUObj.Barrier();
+    if (!PCUObj.Self())
+      remove(files[i]);
+  }
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
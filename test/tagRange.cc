@@ -0,0 +1,46 @@
+#include <apf.h>
+#include <apfMDS.h>
+#include <apfBox.h>
+#include <apfMesh2.h>
+#include <gmi_mesh.h>
+#include <lionPrint.h>
+#include <pcu_util.h>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+  pcu::Init(&argc,&argv);
+  {
+  pcu::PCU PCUObj;
+  lion_set_verbosity(1);
+  gmi_register_mesh();
+  apf::Mesh2* m = apf::makeMdsBox(3, 3, 3, 1, 1, 1, true, &PCUObj);
+  int dim = m->getDimension();
+  int n = m->count(dim);
+  apf::MeshTag* tag = m->createDoubleTag("value", 2);
+  std::vector<double> in(2 * n);
+  for (int i = 0; i < 2 * n; ++i)
+    in[i] = i;
+  apf::setMdsDoubleTagRange(m, tag, dim, 0, n, &in[0]);
+  for (int i = 0; i < n; ++i) {
+    double v[2];
+    m->getDoubleTag(apf::getMdsEntity(m, dim, i), tag, v);
+    PCU_ALWAYS_ASSERT(v[0] == 2 * i && v[1] == 2 * i + 1);
+  }
+  std::vector<double> out(2 * (n - 5));
+  apf::getMdsDoubleTagRange(m, tag, dim, 5, n - 5, &out[0]);
+  for (int i = 0; i < n - 5; ++i)
+    PCU_ALWAYS_ASSERT(out[2 * i] == in[2 * (i + 5)]);
+  double* raw = static_cast<double*>(
+      apf::getMdsTagArray(m, tag, apf::Mesh::TET));
+  raw[3] = -1;
+  double v[2];
+  m->getDoubleTag(apf::getMdsEntity(m, dim, 1), tag, v);
+  PCU_ALWAYS_ASSERT(v[1] == -1);
+  apf::removeTagFromDimension(m, tag, dim);
+  m->destroyTag(tag);
+  m->destroyNative();
+  apf::destroyMesh(m);
+  }
+  pcu::Finalize();
+}
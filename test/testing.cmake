@@ -76,6 +76,27 @@ mpi_test(test_matrix_gradient 1
          "${MESHES}/cube/cube.dmg"
          "${MESHES}/cube/pumi11/cube.smb"
          )
+mpi_test(freezeAdjacency 1 ./freezeAdjacency)
+mpi_test(parallelFor 1 ./parallelFor)
+mpi_test(tagRange 1 ./tagRange)
+mpi_test(smbMap 1 ./smbMap)
+mpi_test(sfcOrder 1 ./sfcOrder)
+mpi_test(compactRemotes 2 ./compactRemotes)
+mpi_test(pcuNeighbors 4 ./pcuNeighbors)
+mpi_test(pcuCollectives 4 ./pcuCollectives)
+mpi_test(pcuCount 4 ./pcuCount)
+mpi_test(pcuArrays 2 ./pcuArrays)
+mpi_test(pcuShared 4 ./pcuShared)
+mpi_test(pcuProfile 4 ./pcuProfile)
+mpi_test(pcuHierarchy 4 ./pcuHierarchy)
+mpi_test(pcuBatch 4 ./pcuBatch)
+mpi_test(pcuThreads 4 ./pcuThreads)
+mpi_test(smbShared 4 ./smbShared)
+mpi_test(shapeTable 1 ./shapeTable)
+mpi_test(elementBlock 1 ./elementBlock)
+mpi_test(geometryCache 1 ./geometryCache)
+mpi_test(elementReset 1 ./elementReset)
+mpi_test(frozenField 1 ./frozenField)
 
 mpi_test(modelInfo_dmg 1
   ./modelInfo